@@ -0,0 +1,48 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Several threads fan the same message out to 64 subscribers and tear the copies down again,
+// all hammering one strong_ref cache line. Per-copy atomics against share_n/release_range
+
+constexpr size_t fanout = 64;
+constexpr size_t rounds = 50000;
+
+template<typename Body>
+auto run(const char* name, unsigned threads, Body body) -> void
+{
+    auto msg = iosp::make_shared<int>(42);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&] {
+            std::vector<iosp::shared_ptr<int>> copies;
+            copies.reserve(fanout);
+            for(size_t r = 0; r < rounds; r++)
+                body(msg, copies);
+        });
+    for(auto& w : workers)
+        w.join();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << threads << " threads: " << ms << " ms\n";
+}
+
+int main()
+{
+    for(unsigned threads : {1u, 4u}) {
+        run("per copy: ", threads, [](const iosp::shared_ptr<int>& msg, std::vector<iosp::shared_ptr<int>>& copies) {
+            for(size_t i = 0; i < fanout; i++)
+                copies.push_back(msg);
+            copies.clear();
+        });
+        run("batched:  ", threads, [](const iosp::shared_ptr<int>& msg, std::vector<iosp::shared_ptr<int>>& copies) {
+            iosp::share_into(msg, fanout, std::back_inserter(copies));
+            iosp::release_range(copies.begin(), copies.end());
+            copies.clear();
+        });
+    }
+    return 0;
+}
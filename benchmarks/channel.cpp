@@ -0,0 +1,129 @@
+#include "../unique_ptr.hpp"
+#include "../channel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work items handed from producers to consumers: a mutex guarded deque of unique_ptrs (what the
+// pipeline stages use today) against the channel, one item at a time and in batches of 32
+
+struct Item {
+    long value;
+    explicit Item(long v) : value(v) {}
+};
+
+using item_ptr = iosp::unique_ptr<Item>;
+
+constexpr long total = 1 << 20;
+constexpr size_t batch = 32;
+
+struct locked_queue
+{
+    std::mutex mutex;
+    std::deque<item_ptr> items;
+    bool closed = false;
+
+    auto push(item_ptr& u) -> void {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(u));
+    }
+    auto pop(item_ptr& out) -> bool {
+        for(;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!items.empty()) {
+                    out = std::move(items.front());
+                    items.pop_front();
+                    return true;
+                }
+                if(closed)
+                    return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+    auto close() -> void {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+};
+
+template<typename Produce, typename Consume, typename Close>
+auto run(const char* name, int pairs, Produce produce, Consume consume, Close close) -> void
+{
+    std::vector<std::thread> producers, consumers;
+    std::vector<long> sums(pairs);
+    auto start = std::chrono::steady_clock::now();
+    for(int p = 0; p < pairs; p++)
+        producers.emplace_back([&, p] { produce(p * (total / pairs), (p + 1) * (total / pairs)); });
+    for(int c = 0; c < pairs; c++)
+        consumers.emplace_back([&, c] { sums[c] = consume(); });
+    for(auto& t : producers)
+        t.join();
+    close();
+    for(auto& t : consumers)
+        t.join();
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    long sum = 0;
+    for(long s : sums)
+        sum += s;
+    std::cout << name << pairs << "x" << pairs << ": " << us / 1000 << " ms, "
+              << total * 1000 / (us ? us : 1) << "k items/s" << (sum == total * (total - 1) / 2 ? "" : " (WRONG SUM)") << "\n";
+}
+
+int main()
+{
+    for(int pairs : {1, 2, 4}) {
+        {
+            locked_queue q;
+            run("mutex + deque:        ", pairs,
+                [&](long from, long to) { for(long i = from; i < to; i++) { item_ptr u(new Item(i)); q.push(u); } },
+                [&] { long s = 0; item_ptr u; while(q.pop(u)) s += u->value; return s; },
+                [&] { q.close(); });
+        }
+        {
+            iosp::channel<Item> ch(1024);
+            run("channel:              ", pairs,
+                [&](long from, long to) { for(long i = from; i < to; i++) { item_ptr u(new Item(i)); ch.push(u); } },
+                [&] { long s = 0; item_ptr u; while(ch.pop(u)) s += u->value; return s; },
+                [&] { ch.close(); });
+        }
+        {
+            iosp::channel<Item> ch(1024);
+            run("channel, batches:     ", pairs,
+                [&](long from, long to) {
+                    std::vector<item_ptr> out;
+                    for(long i = from; i < to; i += batch) {
+                        for(long j = i; j < std::min(i + long(batch), to); j++)
+                            out.emplace_back(new Item(j));
+                        auto it = out.begin();
+                        while((it = ch.try_push_n(it, out.end())) != out.end())
+                            std::this_thread::yield();
+                        out.clear();
+                    }
+                },
+                [&] {
+                    long s = 0;
+                    std::vector<item_ptr> in;
+                    item_ptr u;
+                    for(;;) {
+                        if(ch.try_pop_n(std::back_inserter(in), batch) == 0) {
+                            if(!ch.pop(u)) // blocks until more arrive or the channel is drained
+                                return s;
+                            s += u->value;
+                            continue;
+                        }
+                        for(auto& v : in)
+                            s += v->value;
+                        in.clear();
+                    }
+                },
+                [&] { ch.close(); });
+        }
+    }
+    return 0;
+}
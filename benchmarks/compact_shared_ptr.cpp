@@ -0,0 +1,43 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include "../compact_shared_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// A large container of handles walked in random order: half the handle footprint means more of
+// the container stays in cache while the object behind each handle is read
+
+struct Item {
+    long long value;
+    explicit Item(long long v) : value(v) {}
+};
+
+constexpr size_t count = 4000000;
+constexpr size_t lookups = 20000000;
+
+template<typename Handle, typename Make>
+auto run(const char* name, Make make) -> void
+{
+    std::vector<Handle> handles;
+    handles.reserve(count);
+    for(size_t i = 0; i < count; i++)
+        handles.push_back(make(i));
+
+    std::mt19937_64 rng(7);
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < lookups; i++)
+        sum += handles[rng() % count]->value;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << handles.size() * sizeof(Handle) / (1 << 20) << " MB of handles, "
+              << ms << " ms for random reads (checksum " << sum << ")\n";
+}
+
+int main()
+{
+    run<iosp::shared_ptr<Item>>("shared_ptr:         ", [](size_t i) { return iosp::make_shared<Item>((long long)i); });
+    run<iosp::compact_shared_ptr<Item>>("compact_shared_ptr: ", [](size_t i) { return iosp::make_compact_shared<Item>((long long)i); });
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include "../cow_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Read-heavy workload: every reader takes its own handle to a large blob, and only
+// one in write_every handles actually modifies it. Copying the blob for every reader
+// is compared against cow_ptr, which only copies on the writes
+
+static size_t blob_copies = 0;
+
+struct Blob {
+    std::vector<char> data;
+    Blob(size_t n, char fill) : data(n, fill) {}
+    Blob(const Blob& other) : data(other.data) { blob_copies++; }
+};
+
+constexpr size_t blob_size = 1 << 20;
+constexpr size_t readers = 10000;
+constexpr size_t write_every = 100;
+
+int main()
+{
+    using clock = std::chrono::steady_clock;
+    size_t checksum = 0;
+
+    {
+        blob_copies = 0;
+        Blob source(blob_size, 'x');
+        auto start = clock::now();
+        for(size_t i = 0; i < readers; i++) {
+            Blob copy(source);
+            if(i % write_every == 0)
+                copy.data[0] = 'y';
+            checksum += copy.data[i % blob_size];
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+        std::cout << "eager copy: " << ms << " ms, " << blob_copies << " copies\n";
+    }
+
+    {
+        blob_copies = 0;
+        iosp::cow_ptr<Blob> source = iosp::make_cow<Blob>(blob_size, 'x');
+        auto start = clock::now();
+        for(size_t i = 0; i < readers; i++) {
+            iosp::cow_ptr<Blob> handle = source;
+            if(i % write_every == 0)
+                handle.write().data[0] = 'y';
+            checksum += handle->data[i % blob_size];
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+        std::cout << "cow_ptr:    " << ms << " ms, " << blob_copies << " copies\n";
+    }
+
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every request copies the process-wide default config into a shared_ptr of its own and drops it.
+// With a mortal control block all threads hammer the same counter; an immortal one is only read
+
+struct Config {
+    std::string name = "default";
+    int retries = 3;
+};
+
+constexpr int copies = 5000000;
+
+auto run(const char* name, const iosp::shared_ptr<Config>& config, int threads) -> void
+{
+    std::vector<std::thread> workers;
+    std::vector<long long> sums(threads);
+    auto start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            long long sum = 0;
+            for(int i = 0; i < copies; i++) {
+                iosp::shared_ptr<Config> local = config; // copy construction
+                iosp::shared_ptr<Config> other;
+                other = local; // copy assignment
+                sum += other->retries;
+            } // two destructions
+            sums[t] = sum;
+        });
+    }
+    for(auto& w : workers)
+        w.join();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << threads << " threads: " << ms << " ms (checksum " << sums[0] << ")\n";
+}
+
+int main()
+{
+    auto mortal = iosp::make_shared<Config>();
+    auto immortal = iosp::make_immortal_shared<Config>();
+    for(int threads : {1, 4}) {
+        run("make_shared, mortal:    ", mortal, threads);
+        run("make_immortal_shared:   ", immortal, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "../unique_ptr.hpp"
+#include "../inline_unique.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// A million small polymorphic objects: built, shuffled the way a sorted or reordered container
+// ends up, summed over 20 passes and destroyed. Behind unique_ptr each is an allocation and a
+// pointer chase to wherever it landed; held inline the objects move with their slots
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual auto area() const -> double = 0;
+};
+
+struct Square : Shape {
+    double side;
+    explicit Square(double s) : side(s) {}
+    auto area() const -> double override { return side * side; }
+};
+
+struct Rect : Shape {
+    double w, h;
+    Rect(double a, double b) : w(a), h(b) {}
+    auto area() const -> double override { return w * h; }
+};
+
+constexpr int count = 1000000;
+
+template<typename Handle, typename Make>
+auto run(const char* name, Make make) -> void
+{
+    auto start = std::chrono::steady_clock::now();
+    double total = 0;
+    {
+        std::vector<Handle> shapes;
+        shapes.reserve(count);
+        for(int i = 0; i < count; i++)
+            make(shapes.emplace_back(), i);
+        std::shuffle(shapes.begin(), shapes.end(), std::mt19937(5));
+        for(int pass = 0; pass < 20; pass++)
+            for(auto& s : shapes)
+                total += s->area();
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ms << " ms (checksum " << total << ")\n";
+}
+
+int main()
+{
+    for(int round = 0; round < 2; round++) {
+        run<iosp::unique_ptr<Shape>>("unique_ptr<Shape>:        ", [](iosp::unique_ptr<Shape>& s, int i) {
+            if(i % 2)
+                s.reset(new Square(i % 7));
+            else
+                s.reset(new Rect(i % 5, 2));
+        });
+        run<iosp::inline_unique<Shape, 32>>("inline_unique<Shape, 32>: ", [](iosp::inline_unique<Shape, 32>& s, int i) {
+            if(i % 2)
+                s.template emplace<Square>(double(i % 7));
+            else
+                s.template emplace<Rect>(double(i % 5), 2.0);
+        });
+    }
+    return 0;
+}
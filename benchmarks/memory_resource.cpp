@@ -0,0 +1,67 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+
+// Builds and drops batches of small shared objects through allocate_shared with
+// each resource. Monotonic releases everything at once when the batch ends
+
+struct Node {
+    int key;
+    double value;
+    Node(int k, double v) : key(k), value(v) {}
+};
+
+constexpr size_t batch = 100000;
+constexpr size_t rounds = 20;
+
+template<typename MakeResource>
+auto run(const char* name, MakeResource make_resource) -> void
+{
+    using clock = std::chrono::steady_clock;
+    long long sum = 0;
+    auto start = clock::now();
+    for(size_t r = 0; r < rounds; r++) {
+        auto resource = make_resource();
+        std::vector<iosp::shared_ptr<Node>> nodes;
+        nodes.reserve(batch);
+        for(size_t i = 0; i < batch; i++)
+            nodes.push_back(iosp::allocate_shared<Node>(resource.get(), int(i), i * 0.5));
+        for(auto& n : nodes)
+            sum += n->key;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+    std::cout << name << ms << " ms (checksum " << sum << ")\n";
+}
+
+struct default_resource_handle {
+    auto get() const -> std::pmr::memory_resource* { return std::pmr::new_delete_resource(); }
+};
+
+int main()
+{
+    run("default:     ", [] { return default_resource_handle{}; });
+    run("monotonic:   ", [] { return std::make_unique<std::pmr::monotonic_buffer_resource>(); });
+    run("pool:        ", [] { return std::make_unique<std::pmr::unsynchronized_pool_resource>(); });
+    run("synch pool:  ", [] { return std::make_unique<std::pmr::synchronized_pool_resource>(); });
+
+    {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        long long sum = 0;
+        for(size_t r = 0; r < rounds; r++) {
+            std::vector<iosp::shared_ptr<Node>> nodes;
+            nodes.reserve(batch);
+            for(size_t i = 0; i < batch; i++)
+                nodes.push_back(iosp::make_shared<Node>(int(i), i * 0.5));
+            for(auto& n : nodes)
+                sum += n->key;
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+        std::cout << "make_shared: " << ms << " ms (checksum " << sum << ")\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include "../parallel_destroy.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Evicting a cache of 10M entries, a quarter of them referenced twice: vector::clear() on one thread
+// against parallel_destroy with growing thread counts
+
+struct Entry {
+    long key;
+    std::string value;
+    explicit Entry(long k) : key(k), value(40, 'v') {} // past the small string buffer, one more free per entry
+};
+
+constexpr long count = 10000000;
+
+auto fill() -> std::vector<iosp::shared_ptr<Entry>>
+{
+    std::vector<iosp::shared_ptr<Entry>> cache;
+    cache.reserve(count);
+    for(long i = 0; i < count; i++) {
+        if(i % 4 == 3)
+            cache.push_back(cache[i - 2]); // shared, and usually in another slice
+        else
+            cache.push_back(iosp::make_shared<Entry>(i));
+    }
+    return cache;
+}
+
+template<typename Destroy>
+auto run(const char* name, Destroy destroy) -> void
+{
+    auto cache = fill();
+    auto start = std::chrono::steady_clock::now();
+    destroy(cache);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ms << " ms\n";
+}
+
+int main()
+{
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    run("clear():                  ", [](auto& c) { c.clear(); });
+    for(std::size_t threads : {1, 2, 4, 8}) {
+        std::cout << "parallel_destroy, " << threads << " threads: ";
+        run("", [&](auto& c) { iosp::parallel_destroy(c.begin(), c.end(), threads); c.clear(); });
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Reference count traffic only: each thread copies and drops either its own pointer (uncontended)
+// or one pointer every thread shares (contended). Also the use_count() reads a hot loop might do
+
+struct Payload {
+    long long value = 1;
+};
+
+constexpr int rounds = 5000000;
+
+template<typename Body>
+auto run(const char* name, int threads, Body body) -> void
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++)
+        workers.emplace_back(body);
+    for(auto& w : workers)
+        w.join();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << threads << " threads: " << ms << " ms\n";
+}
+
+int main()
+{
+    auto shared = iosp::make_shared<Payload>();
+    for(int threads : {1, 4}) {
+        run("copy+drop, own pointer:     ", threads, [] {
+            auto own = iosp::make_shared<Payload>();
+            long long sum = 0;
+            for(int i = 0; i < rounds; i++) {
+                iosp::shared_ptr<Payload> copy = own;
+                sum += copy->value;
+            }
+            if(sum != rounds)
+                std::cout << "bad sum\n";
+        });
+        run("copy+drop, shared pointer:  ", threads, [&] {
+            long long sum = 0;
+            for(int i = 0; i < rounds; i++) {
+                iosp::shared_ptr<Payload> copy = shared;
+                sum += copy->value;
+            }
+            if(sum != rounds)
+                std::cout << "bad sum\n";
+        });
+        run("use_count reads:            ", threads, [&] {
+            size_t sum = 0;
+            for(int i = 0; i < rounds * 4; i++)
+                sum += shared.use_count();
+            if(sum == 0)
+                std::cout << "bad sum\n";
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include "../serialization.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// DAG where every node links to two random earlier nodes, so most nodes are reached many
+// times. Pass the node count as the first argument to scale the snapshot up
+
+struct Node {
+    std::uint64_t key = 0;
+    std::vector<float> payload;
+    iosp::shared_ptr<Node> left;
+    iosp::shared_ptr<Node> right;
+
+    template<typename Archive>
+    void serialize(Archive& ar) { ar(key, payload, left, right); }
+};
+
+int main(int argc, char** argv)
+{
+    using clock = std::chrono::steady_clock;
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937_64 rng(42);
+    std::vector<iosp::shared_ptr<Node>> nodes;
+    nodes.reserve(count);
+    for(size_t i = 0; i < count; i++) {
+        auto n = iosp::make_shared<Node>();
+        n->key = i;
+        n->payload.assign(16, float(i));
+        if(i > 0) {
+            n->left = nodes[rng() % i];
+            n->right = nodes[rng() % i];
+        }
+        nodes.push_back(std::move(n));
+    }
+
+    std::stringstream buffer;
+    auto start = clock::now();
+    iosp::archive_writer writer(buffer);
+    writer(nodes);
+    double write_s = std::chrono::duration<double>(clock::now() - start).count();
+    double mb = double(buffer.tellp()) / (1 << 20);
+
+    std::cout << "nodes: " << count << ", snapshot " << mb << " MB\n";
+    std::cout << "written once: " << writer.shared_objects() << ", back references: " << writer.shared_references() << "\n";
+    std::cout << "write: " << write_s * 1000 << " ms, " << mb / write_s << " MB/s\n";
+
+    std::vector<iosp::shared_ptr<Node>> loaded;
+    start = clock::now();
+    {
+        iosp::archive_reader reader(buffer);
+        reader(loaded);
+    }
+    double read_s = std::chrono::duration<double>(clock::now() - start).count();
+    std::cout << "read:  " << read_s * 1000 << " ms, " << mb / read_s << " MB/s\n";
+    std::cout << "round trip ok: " << (loaded.size() == count && loaded.back()->key == count - 1) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "../unique_ptr.hpp"
+#include "../shared_ptr.hpp"
+#include "../slot_map.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Walking every live entity: shared_ptrs to objects allocated in churned order versus the packed
+// storage of a slot_map, then resolving handles in random order
+
+struct Particle {
+    float x, y, vx, vy;
+};
+
+constexpr size_t count = 2000000;
+
+template<typename F>
+auto time_ms(F f) -> long long
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::mt19937 rng(3);
+
+    std::vector<iosp::shared_ptr<Particle>> shared;
+    std::vector<iosp::shared_ptr<Particle>> churn;
+    for(size_t i = 0; i < count; i++) {
+        shared.push_back(iosp::make_shared<Particle>(Particle{float(i), 0, 1, 1}));
+        churn.push_back(iosp::make_shared<Particle>(Particle{}));
+    }
+    churn.clear(); // leaves holes between the live objects
+    std::shuffle(shared.begin(), shared.end(), rng);
+
+    iosp::slot_map<Particle> packed;
+    std::vector<iosp::handle<Particle>> handles;
+    for(size_t i = 0; i < count; i++)
+        handles.push_back(packed.emplace(Particle{float(i), 0, 1, 1}));
+    std::shuffle(handles.begin(), handles.end(), rng);
+
+    float sum = 0;
+    auto a = time_ms([&] { for(int r = 0; r < 10; r++) for(auto& p : shared) { p->x += p->vx; sum += p->x; } });
+    auto b = time_ms([&] { for(int r = 0; r < 10; r++) for(auto& p : packed) { p.x += p.vx; sum += p.x; } });
+    auto c = time_ms([&] { for(int r = 0; r < 10; r++) for(auto h : handles) { auto* p = packed.get(h); p->x += p->vx; sum += p->x; } });
+
+    std::cout << "vector<shared_ptr> walk:     " << a << " ms\n";
+    std::cout << "slot_map linear walk:        " << b << " ms\n";
+    std::cout << "slot_map random handle get:  " << c << " ms (checksum " << sum << ")\n";
+    return 0;
+}
@@ -0,0 +1,265 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "unique_ptr.hpp"
+
+// Bounded multi-producer multi-consumer channel that moves iosp::unique_ptr between threads.
+// Pushing releases the pointer into a preallocated ring and popping adopts it again, so nothing is
+// allocated per item. Each cell carries a sequence number saying which lap of the ring may write or
+// read it next (Vyukov's bounded queue), so producers and consumers only contend on their own index.
+// Stateful deleters travel with their pointer, empty ones take no space in the cell
+
+namespace iosp { // implementation of smart pointers
+    template<typename T, typename Deleter = std::default_delete<T>>
+    class channel;
+}
+
+template<typename T, typename Deleter>
+class iosp::channel
+{
+    using item_type = iosp::unique_ptr<T, Deleter>;
+
+    struct cell
+    {
+        std::atomic_size_t sequence;
+        T* pointer;
+        [[no_unique_address]] Deleter deleter;
+    };
+
+    cell* cells;
+    const std::size_t mask;
+    alignas(64) std::atomic_size_t enqueue_pos{0};
+    alignas(64) std::atomic_size_t dequeue_pos{0};
+    alignas(64) std::atomic_bool closed{false};
+
+    static auto round_up(std::size_t n) noexcept -> std::size_t;
+    auto claim_push(std::size_t want) noexcept -> std::pair<std::size_t, std::size_t>; // first position, how many
+    auto claim_pop(std::size_t want) noexcept -> std::pair<std::size_t, std::size_t>;
+    auto put(std::size_t pos, item_type& u) noexcept -> void;
+    auto take(std::size_t pos) noexcept -> item_type;
+
+public:
+    // Constructors && Destructor
+    explicit channel(std::size_t capacity); // rounded up to a power of two
+    channel(const channel&) = delete;
+    ~channel(); // items still queued are destroyed with their deleters
+
+    // Operators
+    auto operator=(const channel&) -> channel& = delete;
+
+    // Members
+    _NODISCARD auto try_push(item_type& u) noexcept -> bool; // u keeps its object when the ring is full
+    _NODISCARD auto try_pop(item_type& out) noexcept -> bool;
+    template<typename ForwardIt>
+    auto try_push_n(ForwardIt first, ForwardIt last) noexcept -> ForwardIt; // one claim for the whole run, returns the first not sent
+    template<typename OutputIt>
+    auto try_pop_n(OutputIt out, std::size_t max) -> std::size_t; // if out throws, the items not yet written are destroyed
+
+    auto push(item_type& u) -> bool; // waits for room, false once closed
+    auto pop(item_type& out) -> bool; // waits for an item, false once closed and drained
+    auto close() noexcept -> void; // after the producers are done, a push racing with it may go undelivered
+    _NODISCARD auto capacity() const noexcept -> std::size_t;
+    _NODISCARD auto size_approx() const noexcept -> std::size_t;
+};
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::round_up(std::size_t n) noexcept -> std::size_t
+{
+    std::size_t p = 2;
+    while(p < n)
+        p <<= 1;
+    return p;
+}
+
+template <typename T, typename Deleter>
+iosp::channel<T, Deleter>::channel(std::size_t capacity) : cells(nullptr), mask(round_up(capacity) - 1)
+{
+    static_assert(std::is_nothrow_move_constructible_v<Deleter> && std::is_nothrow_default_constructible_v<Deleter>,
+                  "Deleters travel through the ring, they must move and default construct without throwing");
+    cells = static_cast<cell*>(::operator new(sizeof(cell) * (mask + 1), std::align_val_t{alignof(cell)}));
+    for(std::size_t i = 0; i <= mask; i++) {
+        new (&cells[i].sequence) std::atomic_size_t(i);
+        cells[i].pointer = nullptr;
+        new (&cells[i].deleter) Deleter();
+    }
+}
+
+template <typename T, typename Deleter>
+iosp::channel<T, Deleter>::~channel()
+{
+    item_type u;
+    while(try_pop(u))
+        u.reset();
+    for(std::size_t i = 0; i <= mask; i++)
+        cells[i].deleter.~Deleter();
+    ::operator delete(cells, std::align_val_t{alignof(cell)});
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::claim_push(std::size_t want) noexcept -> std::pair<std::size_t, std::size_t>
+{
+    std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for(;;) {
+        std::size_t ready = 0;
+        while(ready < want) { // a cell free for this lap stays free until whoever claims its position fills it
+            cell& c = cells[(pos + ready) & mask];
+            if(c.sequence.load(std::memory_order_acquire) != pos + ready)
+                break;
+            ready++;
+        }
+        if(ready == 0) {
+            std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+            if(static_cast<std::ptrdiff_t>(seq - pos) < 0)
+                return {pos, 0}; // full, the cell still holds last lap's item
+            pos = enqueue_pos.load(std::memory_order_relaxed); // another producer got there first
+            continue;
+        }
+        if(enqueue_pos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+            return {pos, ready};
+    }
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::claim_pop(std::size_t want) noexcept -> std::pair<std::size_t, std::size_t>
+{
+    std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for(;;) {
+        std::size_t ready = 0;
+        while(ready < want) {
+            cell& c = cells[(pos + ready) & mask];
+            if(c.sequence.load(std::memory_order_acquire) != pos + ready + 1)
+                break;
+            ready++;
+        }
+        if(ready == 0) {
+            std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+            if(static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0)
+                return {pos, 0}; // empty, or the producer of this position has not finished
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if(dequeue_pos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+            return {pos, ready};
+    }
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::put(std::size_t pos, item_type& u) noexcept -> void
+{
+    cell& c = cells[pos & mask];
+    c.deleter = std::move(u.get_deleter());
+    c.pointer = u.release();
+    c.sequence.store(pos + 1, std::memory_order_release);
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::take(std::size_t pos) noexcept -> item_type
+{
+    cell& c = cells[pos & mask];
+    item_type u(c.pointer, std::move(c.deleter));
+    c.pointer = nullptr;
+    c.sequence.store(pos + mask + 1, std::memory_order_release); // free for the next lap
+    return u;
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::try_push(item_type& u) noexcept -> bool
+{
+    auto [pos, n] = claim_push(1);
+    if(n == 0)
+        return false;
+    put(pos, u);
+    return true;
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::try_pop(item_type& out) noexcept -> bool
+{
+    auto [pos, n] = claim_pop(1);
+    if(n == 0)
+        return false;
+    out = take(pos);
+    return true;
+}
+
+template <typename T, typename Deleter>
+template <typename ForwardIt>
+auto iosp::channel<T, Deleter>::try_push_n(ForwardIt first, ForwardIt last) noexcept -> ForwardIt
+{
+    std::size_t want = static_cast<std::size_t>(std::distance(first, last));
+    if(want == 0)
+        return first;
+    auto [pos, n] = claim_push(want);
+    for(std::size_t i = 0; i < n; i++, ++first)
+        put(pos + i, *first);
+    return first;
+}
+
+template <typename T, typename Deleter>
+template <typename OutputIt>
+auto iosp::channel<T, Deleter>::try_pop_n(OutputIt out, std::size_t max) -> std::size_t
+{
+    if(max == 0)
+        return 0;
+    auto [pos, n] = claim_pop(max);
+    std::size_t i = 0;
+    try {
+        for(; i < n; i++)
+            *out++ = take(pos + i);
+    } catch(...) {
+        // every claimed cell must still be handed back to the producers or the ring loses it for good
+        for(i++; i < n; i++)
+            take(pos + i);
+        throw;
+    }
+    return n;
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::push(item_type& u) -> bool
+{
+    while(!closed.load(std::memory_order_acquire)) {
+        if(try_push(u))
+            return true;
+        std::this_thread::yield();
+    }
+    return false;
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::pop(item_type& out) -> bool
+{
+    for(;;) {
+        if(try_pop(out))
+            return true;
+        // once closed, wait only for positions already claimed by producers
+        if(closed.load(std::memory_order_acquire)
+           && dequeue_pos.load(std::memory_order_acquire) == enqueue_pos.load(std::memory_order_acquire))
+            return false;
+        std::this_thread::yield();
+    }
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::close() noexcept -> void
+{
+    closed.store(true, std::memory_order_release);
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::capacity() const noexcept -> std::size_t
+{
+    return mask + 1;
+}
+
+template <typename T, typename Deleter>
+auto iosp::channel<T, Deleter>::size_approx() const noexcept -> std::size_t
+{
+    std::size_t head = dequeue_pos.load(std::memory_order_relaxed);
+    std::size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
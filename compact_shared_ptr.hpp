@@ -0,0 +1,175 @@
+#pragma once
+#include <stdexcept>
+#include <utility>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+namespace iosp { // implementation of smart pointers
+    template<typename T, typename... Args>
+    _NODISCARD auto make_compact_shared(Args&&... args) -> iosp::compact_shared_ptr<T>;
+}
+
+// One word shared pointer for objects built by make_shared: only the control block is stored,
+// the object sits at a fixed offset behind it. No aliasing, so anything else is rejected on conversion
+template<typename T>
+class iosp::compact_shared_ptr
+{
+    using _CB = make_shared_control_block<T>;
+    _CB* cb = nullptr;
+
+    explicit compact_shared_ptr(_CB* _Cb) noexcept : cb(_Cb) {}
+    static auto adopt(iosp::shared_ptr<T>&& s) noexcept -> compact_shared_ptr; // s must come from make_shared<T>
+    template<typename U, typename... Args>
+    friend auto iosp::make_compact_shared(Args&&... args) -> iosp::compact_shared_ptr<U>;
+
+public:
+    // Constructors && Destructor
+    compact_shared_ptr() noexcept = default;
+    compact_shared_ptr(std::nullptr_t) noexcept {}
+    explicit compact_shared_ptr(const iosp::shared_ptr<T>& s); // throws std::invalid_argument unless s came from make_shared<T>
+    compact_shared_ptr(const compact_shared_ptr& c) noexcept;
+    compact_shared_ptr(compact_shared_ptr&& c) noexcept;
+    ~compact_shared_ptr();
+
+    // Operators
+    auto operator=(const compact_shared_ptr& c) noexcept -> compact_shared_ptr&;
+    auto operator=(compact_shared_ptr&& c) noexcept -> compact_shared_ptr&;
+    auto operator=(std::nullptr_t) noexcept -> compact_shared_ptr&;
+    _NODISCARD auto operator*() const noexcept -> T&;
+    _NODISCARD auto operator->() const noexcept -> T*;
+    explicit operator bool() const noexcept;
+    _NODISCARD operator iosp::shared_ptr<T>() const noexcept;
+
+    // Members
+    _NODISCARD auto get() const noexcept -> T*;
+    _NODISCARD auto use_count() const noexcept -> std::size_t;
+    _NODISCARD auto to_shared() const noexcept -> iosp::shared_ptr<T>;
+    auto reset() noexcept -> void;
+    auto swap(compact_shared_ptr& other) noexcept -> void;
+};
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_compact_shared(Args&&... args) -> iosp::compact_shared_ptr<T>
+{
+    return iosp::compact_shared_ptr<T>::adopt(iosp::make_shared<T>(std::forward<Args>(args)...));
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::adopt(iosp::shared_ptr<T>&& s) noexcept -> compact_shared_ptr
+{
+    auto* cb_ = static_cast<_CB*>(s.cb);
+    s.cb = nullptr; // the reference moves into the compact pointer
+    s.pointer = nullptr;
+    return compact_shared_ptr(cb_);
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::compact_shared_ptr(const iosp::shared_ptr<T>& s)
+{
+    if(!s.cb)
+        return;
+    auto* cb_ = dynamic_cast<_CB*>(s.cb);
+    if(!cb_ || cb_->object() != s.pointer)
+        throw std::invalid_argument("compact_shared_ptr needs an unaliased shared_ptr from make_shared<T>");
+    cb = cb_;
+    cb->add_ref();
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::compact_shared_ptr(const compact_shared_ptr& c) noexcept : cb(c.cb)
+{
+    if(cb)
+        cb->add_ref();
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::compact_shared_ptr(compact_shared_ptr&& c) noexcept : cb(c.cb)
+{
+    c.cb = nullptr;
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::~compact_shared_ptr()
+{
+    reset();
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::operator=(const compact_shared_ptr& c) noexcept -> compact_shared_ptr&
+{
+    compact_shared_ptr(c).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::operator=(compact_shared_ptr&& c) noexcept -> compact_shared_ptr&
+{
+    compact_shared_ptr(std::move(c)).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::operator=(std::nullptr_t) noexcept -> compact_shared_ptr&
+{
+    reset();
+    return *this;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::operator*() const noexcept -> T&
+{
+    return *get();
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::operator->() const noexcept -> T*
+{
+    return get();
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::operator bool() const noexcept
+{
+    return cb != nullptr;
+}
+
+template <typename T>
+iosp::compact_shared_ptr<T>::operator iosp::shared_ptr<T>() const noexcept
+{
+    return to_shared();
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::get() const noexcept -> T*
+{
+    return cb ? cb->object() : nullptr;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::use_count() const noexcept -> std::size_t
+{
+    return cb ? cb->strong_ref.load(std::memory_order_relaxed) : 0;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::to_shared() const noexcept -> iosp::shared_ptr<T>
+{
+    if(!cb)
+        return iosp::shared_ptr<T>();
+    cb->add_ref();
+    return iosp::shared_ptr<T>(cb->object(), static_cast<control_block*>(cb));
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::reset() noexcept -> void
+{
+    if(cb && cb->drop_ref())
+        cb->destroy();
+    cb = nullptr;
+}
+
+template <typename T>
+auto iosp::compact_shared_ptr<T>::swap(compact_shared_ptr& other) noexcept -> void
+{
+    std::swap(cb, other.cb);
+}
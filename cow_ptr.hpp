@@ -0,0 +1,122 @@
+#pragma once
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+namespace iosp { // implementation of smart pointers
+    template<typename T>
+    class cow_ptr;
+
+    template<typename T, typename... Args>
+    _NODISCARD auto make_cow(Args&&... args) -> iosp::cow_ptr<T>;
+}
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_cow(Args&&... args) -> iosp::cow_ptr<T>
+{
+    return iosp::cow_ptr<T>(iosp::make_shared<T>(std::forward<Args>(args)...));
+}
+
+// Copy-on-write pointer: copies share the same object, and the object is only deep copied
+// when a writer asks for mutable access while someone else still holds it
+template<typename T>
+class iosp::cow_ptr
+{
+    iosp::shared_ptr<T> pointer;
+
+public:
+    // Constructors && Destructor
+    cow_ptr() noexcept = default;
+    cow_ptr(std::nullptr_t) noexcept;
+    explicit cow_ptr(iosp::shared_ptr<T>&& s) noexcept;
+    cow_ptr(const cow_ptr& c) noexcept = default;
+    cow_ptr(cow_ptr&& c) noexcept = default;
+    ~cow_ptr() = default;
+
+    // Operators
+    auto operator=(const cow_ptr& c) -> cow_ptr& = default;
+    auto operator=(cow_ptr&& c) noexcept -> cow_ptr& = default;
+    _NODISCARD auto operator*() const noexcept -> const T&;
+    _NODISCARD auto operator->() const noexcept -> const T*;
+    explicit operator bool() const noexcept;
+
+    // Members
+    _NODISCARD auto get() const noexcept -> const T*;
+    _NODISCARD auto read() const noexcept -> const T&;
+    _NODISCARD auto write() -> T&; // detaches from the other owners if the object is shared
+    _NODISCARD auto unique() const noexcept -> bool;
+    _NODISCARD auto use_count() const noexcept -> std::size_t;
+    auto reset() noexcept -> void;
+    auto swap(cow_ptr& other) noexcept -> void;
+};
+
+template <typename T>
+iosp::cow_ptr<T>::cow_ptr(std::nullptr_t) noexcept : pointer(nullptr) {}
+
+template <typename T>
+iosp::cow_ptr<T>::cow_ptr(iosp::shared_ptr<T>&& s) noexcept : pointer(std::move(s)) {}
+
+template <typename T>
+auto iosp::cow_ptr<T>::operator*() const noexcept -> const T&
+{
+    return *pointer;
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::operator->() const noexcept -> const T*
+{
+    return pointer.get();
+}
+
+template <typename T>
+iosp::cow_ptr<T>::operator bool() const noexcept
+{
+    return static_cast<bool>(pointer);
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::get() const noexcept -> const T*
+{
+    return pointer.get();
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::read() const noexcept -> const T&
+{
+    return *pointer;
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::write() -> T&
+{
+    static_assert(std::is_copy_constructible_v<T>, "cow_ptr::write() needs a copy constructible T");
+    // unique() loads with acquire, so if we are the last owner every write made by a former owner
+    // is visible before we mutate in place. Otherwise detach onto a private copy, the old object
+    // stays untouched for the remaining readers
+    if(pointer && !pointer.unique())
+        pointer = iosp::make_shared<T>(static_cast<const T&>(*pointer));
+    return *pointer;
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::unique() const noexcept -> bool
+{
+    return pointer.unique();
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::use_count() const noexcept -> std::size_t
+{
+    return pointer.use_count();
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::reset() noexcept -> void
+{
+    pointer.reset();
+}
+
+template <typename T>
+auto iosp::cow_ptr<T>::swap(cow_ptr& other) noexcept -> void
+{
+    pointer.swap(other.pointer);
+}
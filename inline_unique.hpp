@@ -0,0 +1,225 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "unique_ptr.hpp"
+
+// Polymorphic single owner with a small buffer: a derived object that fits in N bytes (and moves
+// without throwing) lives inside the inline_unique itself, anything bigger goes to the heap.
+// A per-type table remembers how to destroy the object and how to move it to another buffer,
+// so Base needs no virtual destructor. release() has no equivalent, an inline object has no heap
+// address to hand out
+
+namespace iosp { // implementation of smart pointers
+    template<typename Base, std::size_t N = 48>
+    class inline_unique;
+
+    template<typename Base, typename Derived, std::size_t N = 48, typename... Args>
+    _NODISCARD auto make_inline_unique(Args&&... args) -> iosp::inline_unique<Base, N>;
+}
+
+template<typename Base>
+struct inline_unique_ops
+{
+    void (*destroy)(Base* p) noexcept;
+    Base* (*relocate)(Base* from, void* to) noexcept; // null for heap objects, their pointer just moves
+
+    template<typename Derived>
+    static auto destroy_inline(Base* p) noexcept -> void {
+        static_cast<Derived*>(p)->~Derived();
+    }
+    template<typename Derived>
+    static auto destroy_heap(Base* p) noexcept -> void {
+        delete static_cast<Derived*>(p);
+    }
+    template<typename Derived>
+    static auto relocate_inline(Base* from, void* to) noexcept -> Base* {
+        Derived* src = static_cast<Derived*>(from);
+        Derived* dst = new (to) Derived(std::move(*src));
+        src->~Derived();
+        return dst; // Base may not sit at offset 0 of Derived, the adjusted pointer comes back
+    }
+
+    template<typename Derived>
+    static constexpr inline_unique_ops in_buffer{&destroy_inline<Derived>, &relocate_inline<Derived>};
+    template<typename Derived>
+    static constexpr inline_unique_ops on_heap{&destroy_heap<Derived>, nullptr};
+};
+
+template<typename Base, std::size_t N>
+class iosp::inline_unique
+{
+    using ops_type = inline_unique_ops<Base>;
+
+    alignas(std::max_align_t) unsigned char buffer[N];
+    Base* pointer = nullptr;
+    const ops_type* ops = nullptr;
+
+    auto move_from(inline_unique& u) noexcept -> void;
+
+public:
+    template<typename Derived>
+    static constexpr bool fits_inline = sizeof(Derived) <= N && alignof(Derived) <= alignof(std::max_align_t)
+                                        && std::is_nothrow_move_constructible_v<Derived>;
+
+    // Constructors && Destructor
+    inline_unique() noexcept = default;
+    inline_unique(std::nullptr_t) noexcept {}
+    template<typename Derived, typename Deleter>
+    inline_unique(iosp::unique_ptr<Derived, Deleter>&& u) noexcept; // adopts the heap object as it is
+    inline_unique(inline_unique&& u) noexcept;
+    inline_unique(const inline_unique&) = delete;
+    ~inline_unique();
+
+    // Operators
+    auto operator=(inline_unique&& u) noexcept -> inline_unique&;
+    auto operator=(std::nullptr_t) noexcept -> inline_unique&;
+    auto operator=(const inline_unique&) -> inline_unique& = delete;
+    _NODISCARD auto operator*() const noexcept -> Base&;
+    _NODISCARD auto operator->() const noexcept -> Base*;
+    explicit operator bool() const noexcept;
+
+    // Members
+    template<typename Derived, typename... Args>
+    auto emplace(Args&&... args) -> Base&; // inline when it fits, heap otherwise
+    _NODISCARD auto get() const noexcept -> Base*;
+    _NODISCARD auto is_inline() const noexcept -> bool;
+    auto reset() noexcept -> void;
+    template<typename Derived>
+    auto reset(Derived* _Ptr) noexcept -> void; // takes ownership of a heap object
+    auto swap(inline_unique& other) noexcept -> void;
+};
+
+template<typename Base, typename Derived, std::size_t N, typename... Args>
+_NODISCARD auto iosp::make_inline_unique(Args&&... args) -> iosp::inline_unique<Base, N>
+{
+    iosp::inline_unique<Base, N> u;
+    u.template emplace<Derived>(std::forward<Args>(args)...);
+    return u;
+}
+
+template <typename Base, std::size_t N>
+template <typename Derived, typename Deleter>
+iosp::inline_unique<Base, N>::inline_unique(iosp::unique_ptr<Derived, Deleter>&& u) noexcept
+{
+    static_assert(std::is_same_v<Deleter, std::default_delete<Derived>>, "Only unique_ptrs that delete can be adopted");
+    static_assert(std::is_convertible_v<Derived*, Base*>, "Pointer type must be convertible to Base*");
+    reset(u.release());
+}
+
+template <typename Base, std::size_t N>
+iosp::inline_unique<Base, N>::inline_unique(inline_unique&& u) noexcept
+{
+    move_from(u);
+}
+
+template <typename Base, std::size_t N>
+iosp::inline_unique<Base, N>::~inline_unique()
+{
+    reset();
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::move_from(inline_unique& u) noexcept -> void
+{
+    // this is empty here
+    if(!u.pointer)
+        return;
+    pointer = u.ops->relocate ? u.ops->relocate(u.pointer, buffer) : u.pointer;
+    ops = u.ops;
+    u.pointer = nullptr;
+    u.ops = nullptr;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::operator=(inline_unique&& u) noexcept -> inline_unique&
+{
+    if(this != &u) {
+        reset();
+        move_from(u);
+    }
+    return *this;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::operator=(std::nullptr_t) noexcept -> inline_unique&
+{
+    reset();
+    return *this;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::operator*() const noexcept -> Base&
+{
+    return *pointer;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::operator->() const noexcept -> Base*
+{
+    return pointer;
+}
+
+template <typename Base, std::size_t N>
+iosp::inline_unique<Base, N>::operator bool() const noexcept
+{
+    return pointer != nullptr;
+}
+
+template <typename Base, std::size_t N>
+template <typename Derived, typename... Args>
+auto iosp::inline_unique<Base, N>::emplace(Args&&... args) -> Base&
+{
+    static_assert(std::is_convertible_v<Derived*, Base*>, "Derived must derive publicly from Base");
+    reset();
+    if constexpr(fits_inline<Derived>) {
+        pointer = new (buffer) Derived(std::forward<Args>(args)...);
+        ops = &ops_type::template in_buffer<Derived>;
+    } else {
+        pointer = new Derived(std::forward<Args>(args)...);
+        ops = &ops_type::template on_heap<Derived>;
+    }
+    return *pointer;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::get() const noexcept -> Base*
+{
+    return pointer;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::is_inline() const noexcept -> bool
+{
+    return pointer && ops->relocate;
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::reset() noexcept -> void
+{
+    if(pointer)
+        ops->destroy(pointer);
+    pointer = nullptr;
+    ops = nullptr;
+}
+
+template <typename Base, std::size_t N>
+template <typename Derived>
+auto iosp::inline_unique<Base, N>::reset(Derived* _Ptr) noexcept -> void
+{
+    static_assert(std::is_convertible_v<Derived*, Base*>, "Pointer type must be convertible to Base*");
+    reset();
+    if(_Ptr) {
+        pointer = _Ptr;
+        ops = &ops_type::template on_heap<Derived>;
+    }
+}
+
+template <typename Base, std::size_t N>
+auto iosp::inline_unique<Base, N>::swap(inline_unique& other) noexcept -> void
+{
+    inline_unique tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+// Hash-consing: make_interned<T>(args...) builds the value, and if an equal value is still alive
+// anywhere hands back that one instead. The table only remembers live values, the control block
+// unregisters its entry when the last reference goes, so nothing is kept alive by the table
+
+namespace iosp { // implementation of smart pointers
+    template<typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+    class intern_table;
+
+    struct intern_stats;
+
+    template<typename T, typename... Args>
+    _NODISCARD auto make_interned(Args&&... args) -> iosp::shared_ptr<const T>;
+}
+
+struct iosp::intern_stats
+{
+    size_t live_values; // distinct values currently interned
+    size_t requests; // make_interned calls
+    size_t hits; // calls answered with an existing value
+    size_t bytes_saved; // allocations those hits did not make
+};
+
+template<typename T, typename Table>
+struct interned_control_block : control_block
+{
+    Table* table;
+    size_t hash;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    interned_control_block(Table* t, size_t h) : table(t), hash(h) {}
+    auto object() noexcept -> T* {
+        return reinterpret_cast<T*>(storage);
+    }
+    void destroy() override {
+        table->erase(this);
+        object()->~T();
+        delete this;
+    }
+};
+
+template<typename T, typename Hash, typename KeyEqual>
+class iosp::intern_table
+{
+    using _CB = interned_control_block<T, intern_table>;
+    friend struct interned_control_block<T, intern_table>;
+
+    static constexpr size_t shard_count = 16; // lock striping, unrelated values rarely contend
+
+    struct alignas(64) shard
+    {
+        std::mutex mutex;
+        std::unordered_multimap<size_t, _CB*> entries;
+    };
+
+    std::array<shard, shard_count> shards;
+    Hash hasher;
+    KeyEqual equal;
+    std::atomic_size_t requests{0};
+    std::atomic_size_t hits{0};
+
+    auto shard_for(size_t hash) noexcept -> shard& {
+        return shards[(hash ^ (hash >> 17)) % shard_count];
+    }
+    auto erase(_CB* cb) noexcept -> void;
+
+public:
+    intern_table() = default;
+    intern_table(const intern_table&) = delete;
+    auto operator=(const intern_table&) -> intern_table& = delete;
+
+    static auto instance() -> intern_table&;
+
+    template<typename... Args>
+    _NODISCARD auto intern(Args&&... args) -> iosp::shared_ptr<const T>;
+    _NODISCARD auto stats() -> iosp::intern_stats;
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+auto iosp::intern_table<T, Hash, KeyEqual>::instance() -> intern_table&
+{
+    // never destroyed: interned values held by other statics may be released after main returns
+    static intern_table* table = new intern_table();
+    return *table;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+auto iosp::intern_table<T, Hash, KeyEqual>::intern(Args&&... args) -> iosp::shared_ptr<const T>
+{
+    static_assert(std::is_move_constructible_v<T>, "Interned values are built once and moved into their block");
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    T value(std::forward<Args>(args)...); // on the stack, a hit costs no allocation
+    size_t hash = hasher(value);
+    shard& s = shard_for(hash);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto [first, last] = s.entries.equal_range(hash);
+    for(auto it = first; it != last; ++it) {
+        _CB* cb = it->second;
+        if(!equal(*cb->object(), value))
+            continue;
+        // a count of zero means its last owner is on the way into erase(), build a fresh one
+        size_t count = cb->strong_ref.load(std::memory_order_relaxed);
+        while(count != 0 && !cb->strong_ref.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) {}
+        if(count == 0)
+            continue;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return iosp::shared_ptr<const T>(cb->object(), static_cast<control_block*>(cb));
+    }
+
+    _CB* cb = new _CB(this, hash);
+    try {
+        new (cb->object()) T(std::move(value));
+    } catch(...) {
+        delete cb;
+        throw;
+    }
+    s.entries.emplace(hash, cb);
+    return iosp::shared_ptr<const T>(cb->object(), static_cast<control_block*>(cb));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+auto iosp::intern_table<T, Hash, KeyEqual>::erase(_CB* cb) noexcept -> void
+{
+    shard& s = shard_for(cb->hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto [first, last] = s.entries.equal_range(cb->hash);
+    for(auto it = first; it != last; ++it) {
+        if(it->second == cb) {
+            s.entries.erase(it);
+            return;
+        }
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+auto iosp::intern_table<T, Hash, KeyEqual>::stats() -> iosp::intern_stats
+{
+    size_t live = 0;
+    for(shard& s : shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        live += s.entries.size();
+    }
+    size_t h = hits.load(std::memory_order_relaxed);
+    return iosp::intern_stats{live, requests.load(std::memory_order_relaxed), h, h * sizeof(_CB)};
+}
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_interned(Args&&... args) -> iosp::shared_ptr<const T>
+{
+    return iosp::intern_table<T>::instance().intern(std::forward<Args>(args)...);
+}
@@ -0,0 +1,434 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "unique_ptr.hpp"
+
+// POSIX shared memory (shm_open/mmap) variant of shared_ptr. The control block and the object
+// live inside a named segment and are addressed by offsets from the segment base, so every
+// process can map the segment wherever it likes. The reference count is a lock-free atomic in
+// the segment, the last process to release the object destroys it and frees the block
+
+namespace iosp { // implementation of smart pointers
+    class shm_segment;
+
+    template<typename T>
+    class offset_ptr;
+
+    template<typename T>
+    class interprocess_shared_ptr;
+
+    template<typename T, typename... Args>
+    _NODISCARD auto make_interprocess_shared(shm_segment& segment, Args&&... args) -> iosp::interprocess_shared_ptr<T>;
+}
+
+// Self-relative pointer for links stored inside the segment: it keeps the distance from its own
+// address to the target, which is the same in every mapping
+template<typename T>
+class iosp::offset_ptr
+{
+    std::ptrdiff_t offset = 1; // 1 can never be a valid distance to a T, it stands for null
+
+public:
+    offset_ptr() noexcept = default;
+    offset_ptr(std::nullptr_t) noexcept {}
+    offset_ptr(T* _Ptr) noexcept { *this = _Ptr; }
+    offset_ptr(const offset_ptr& o) noexcept { *this = o.get(); }
+
+    auto operator=(T* _Ptr) noexcept -> offset_ptr& {
+        offset = _Ptr ? reinterpret_cast<const char*>(_Ptr) - reinterpret_cast<const char*>(this) : 1;
+        return *this;
+    }
+    auto operator=(const offset_ptr& o) noexcept -> offset_ptr& {
+        return *this = o.get();
+    }
+    _NODISCARD auto operator*() const noexcept -> T& { return *get(); }
+    _NODISCARD auto operator->() const noexcept -> T* { return get(); }
+    explicit operator bool() const noexcept { return offset != 1; }
+
+    _NODISCARD auto get() const noexcept -> T* {
+        return offset == 1 ? nullptr : reinterpret_cast<T*>(const_cast<char*>(reinterpret_cast<const char*>(this)) + offset);
+    }
+};
+
+// Layout at offset 0 of every segment
+struct shm_header
+{
+    static constexpr std::uint64_t magic_value = 0x696f73702d73686dULL; // "iosp-shm"
+
+    std::uint64_t magic;
+    std::uint64_t size;
+    pthread_mutex_t mutex; // process shared, guards everything below
+    std::uint64_t bump;
+    std::uint64_t free_head;
+    std::uint64_t in_use;
+};
+
+// Every allocation is preceded by one of these; next_free is only meaningful on the free list
+struct alignas(16) shm_chunk
+{
+    std::uint64_t size;
+    std::uint64_t next_free;
+};
+
+class iosp::shm_segment
+{
+    std::string name;
+    void* base = nullptr;
+    std::size_t size = 0;
+
+    shm_segment(std::string n, void* b, std::size_t s) : name(std::move(n)), base(b), size(s) {}
+    auto header() const noexcept -> shm_header* { return static_cast<shm_header*>(base); }
+
+public:
+    static constexpr std::size_t alignment = alignof(shm_chunk);
+
+    // Constructors && Destructor
+    shm_segment(const shm_segment&) = delete;
+    shm_segment(shm_segment&& s) noexcept;
+    ~shm_segment(); // unmaps this process's view, the segment itself stays until unlink()
+
+    static auto create(const std::string& name, std::size_t size) -> shm_segment;
+    static auto open(const std::string& name) -> shm_segment;
+
+    // Operators
+    auto operator=(const shm_segment&) -> shm_segment& = delete;
+
+    // Members
+    auto allocate(std::size_t bytes) -> std::uint64_t; // returns the offset of the payload
+    auto deallocate(std::uint64_t offset) noexcept -> void;
+    _NODISCARD auto bytes_in_use() const noexcept -> std::uint64_t;
+    _NODISCARD auto to_pointer(std::uint64_t offset) const noexcept -> void*;
+    _NODISCARD auto to_offset(const void* p) const noexcept -> std::uint64_t;
+    auto unlink() noexcept -> void; // removes the name, mappings stay valid until unmapped
+};
+
+inline iosp::shm_segment::shm_segment(shm_segment&& s) noexcept
+    : name(std::move(s.name)), base(s.base), size(s.size)
+{
+    s.base = nullptr;
+    s.size = 0;
+}
+
+inline iosp::shm_segment::~shm_segment()
+{
+    if(base)
+        ::munmap(base, size);
+}
+
+inline auto iosp::shm_segment::create(const std::string& name, std::size_t size) -> shm_segment
+{
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Cross-process counts need lock-free 64-bit atomics");
+    size = (size + alignment - 1) / alignment * alignment;
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+    if(::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        int err = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::system_error(err, std::generic_category(), "ftruncate " + name);
+    }
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if(base == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::system_error(err, std::generic_category(), "mmap " + name);
+    }
+
+    shm_header* h = new (base) shm_header();
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&h->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    h->size = size;
+    h->bump = (sizeof(shm_header) + alignment - 1) / alignment * alignment;
+    h->free_head = 0;
+    h->in_use = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = shm_header::magic_value;
+
+    return shm_segment(name, base, size);
+}
+
+inline auto iosp::shm_segment::open(const std::string& name) -> shm_segment
+{
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "fstat " + name);
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if(base == MAP_FAILED)
+        throw std::system_error(err, std::generic_category(), "mmap " + name);
+
+    shm_segment segment(name, base, size);
+    if(segment.header()->magic != shm_header::magic_value)
+        throw std::system_error(EINVAL, std::generic_category(), "not an iosp segment " + name);
+    std::atomic_thread_fence(std::memory_order_acquire); // pairs with the fence before create() writes magic
+    return segment;
+}
+
+inline auto iosp::shm_segment::allocate(std::size_t bytes) -> std::uint64_t
+{
+    std::uint64_t total = sizeof(shm_chunk) + (bytes + alignment - 1) / alignment * alignment;
+    shm_header* h = header();
+
+    pthread_mutex_lock(&h->mutex);
+    std::uint64_t chunk_offset = 0;
+    // first fit on the free list, then carve from the untouched tail
+    for(std::uint64_t* link = &h->free_head; *link; link = &static_cast<shm_chunk*>(to_pointer(*link))->next_free) {
+        shm_chunk* c = static_cast<shm_chunk*>(to_pointer(*link));
+        if(c->size >= total) {
+            chunk_offset = *link;
+            *link = c->next_free;
+            total = c->size;
+            break;
+        }
+    }
+    if(!chunk_offset && h->bump + total <= h->size) {
+        chunk_offset = h->bump;
+        h->bump += total;
+        static_cast<shm_chunk*>(to_pointer(chunk_offset))->size = total;
+    }
+    if(chunk_offset)
+        h->in_use += total;
+    pthread_mutex_unlock(&h->mutex);
+
+    if(!chunk_offset)
+        throw std::bad_alloc();
+    return chunk_offset + sizeof(shm_chunk);
+}
+
+inline auto iosp::shm_segment::deallocate(std::uint64_t offset) noexcept -> void
+{
+    shm_header* h = header();
+    std::uint64_t chunk_offset = offset - sizeof(shm_chunk);
+    shm_chunk* c = static_cast<shm_chunk*>(to_pointer(chunk_offset));
+
+    pthread_mutex_lock(&h->mutex);
+    h->in_use -= c->size;
+    c->next_free = h->free_head;
+    h->free_head = chunk_offset;
+    pthread_mutex_unlock(&h->mutex);
+}
+
+inline auto iosp::shm_segment::bytes_in_use() const noexcept -> std::uint64_t
+{
+    shm_header* h = header();
+    pthread_mutex_lock(&h->mutex);
+    std::uint64_t used = h->in_use;
+    pthread_mutex_unlock(&h->mutex);
+    return used;
+}
+
+inline auto iosp::shm_segment::to_pointer(std::uint64_t offset) const noexcept -> void*
+{
+    return static_cast<char*>(base) + offset;
+}
+
+inline auto iosp::shm_segment::to_offset(const void* p) const noexcept -> std::uint64_t
+{
+    return static_cast<std::uint64_t>(static_cast<const char*>(p) - static_cast<const char*>(base));
+}
+
+inline auto iosp::shm_segment::unlink() noexcept -> void
+{
+    ::shm_unlink(name.c_str());
+}
+
+template<typename T>
+struct interprocess_control_block
+{
+    std::atomic<std::uint64_t> strong_ref{1};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    auto object() noexcept -> T* {
+        return reinterpret_cast<T*>(storage);
+    }
+};
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_interprocess_shared(shm_segment& segment, Args&&... args) -> iosp::interprocess_shared_ptr<T>
+{
+    using _CB = interprocess_control_block<T>;
+    std::uint64_t offset = segment.allocate(sizeof(_CB));
+    _CB* cb = new (segment.to_pointer(offset)) _CB();
+    try {
+        new (cb->object()) T(std::forward<Args>(args)...);
+    } catch(...) {
+        cb->~_CB();
+        segment.deallocate(offset);
+        throw;
+    }
+    return iosp::interprocess_shared_ptr<T>::adopt(segment, offset);
+}
+
+// Process local handle to an object in a segment. Handles never live in the segment themselves,
+// ownership crosses processes as an offset through share_with_process() and adopt()
+template<typename T>
+class iosp::interprocess_shared_ptr
+{
+    static_assert(!std::is_polymorphic_v<T>, "vtable pointers are only valid in the process that built them");
+    static_assert(alignof(T) <= shm_segment::alignment, "Over-aligned types are not supported");
+
+    shm_segment* segment = nullptr;
+    std::uint64_t offset = 0; // of the control block, 0 when empty
+
+    interprocess_shared_ptr(shm_segment* s, std::uint64_t o) noexcept : segment(s), offset(o) {}
+    auto control() const noexcept -> interprocess_control_block<T>* {
+        return static_cast<interprocess_control_block<T>*>(segment->to_pointer(offset));
+    }
+
+public:
+    // Constructors && Destructor
+    interprocess_shared_ptr() noexcept = default;
+    interprocess_shared_ptr(std::nullptr_t) noexcept {}
+    interprocess_shared_ptr(const interprocess_shared_ptr& s) noexcept;
+    interprocess_shared_ptr(interprocess_shared_ptr&& s) noexcept;
+    ~interprocess_shared_ptr();
+
+    static auto adopt(shm_segment& segment, std::uint64_t offset) noexcept -> interprocess_shared_ptr; // takes over one reference
+    static auto attach(shm_segment& segment, std::uint64_t offset) noexcept -> interprocess_shared_ptr; // adds a reference
+
+    // Operators
+    auto operator=(const interprocess_shared_ptr& s) noexcept -> interprocess_shared_ptr&;
+    auto operator=(interprocess_shared_ptr&& s) noexcept -> interprocess_shared_ptr&;
+    _NODISCARD auto operator*() const noexcept -> T&;
+    _NODISCARD auto operator->() const noexcept -> T*;
+    explicit operator bool() const noexcept;
+
+    // Members
+    _NODISCARD auto get() const noexcept -> T*;
+    _NODISCARD auto use_count() const noexcept -> std::size_t;
+    _NODISCARD auto share_with_process() const noexcept -> std::uint64_t; // adds a reference for another process to adopt()
+    auto reset() noexcept -> void;
+    auto swap(interprocess_shared_ptr& other) noexcept -> void;
+};
+
+template <typename T>
+iosp::interprocess_shared_ptr<T>::interprocess_shared_ptr(const interprocess_shared_ptr& s) noexcept
+    : segment(s.segment), offset(s.offset)
+{
+    if(offset)
+        control()->strong_ref.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+iosp::interprocess_shared_ptr<T>::interprocess_shared_ptr(interprocess_shared_ptr&& s) noexcept
+    : segment(s.segment), offset(s.offset)
+{
+    s.segment = nullptr;
+    s.offset = 0;
+}
+
+template <typename T>
+iosp::interprocess_shared_ptr<T>::~interprocess_shared_ptr()
+{
+    reset();
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::adopt(shm_segment& segment, std::uint64_t offset) noexcept -> interprocess_shared_ptr
+{
+    return interprocess_shared_ptr(&segment, offset);
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::attach(shm_segment& segment, std::uint64_t offset) noexcept -> interprocess_shared_ptr
+{
+    interprocess_shared_ptr s(&segment, offset);
+    s.control()->strong_ref.fetch_add(1, std::memory_order_relaxed);
+    return s;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::operator=(const interprocess_shared_ptr& s) noexcept -> interprocess_shared_ptr&
+{
+    interprocess_shared_ptr(s).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::operator=(interprocess_shared_ptr&& s) noexcept -> interprocess_shared_ptr&
+{
+    interprocess_shared_ptr(std::move(s)).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::operator*() const noexcept -> T&
+{
+    return *get();
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::operator->() const noexcept -> T*
+{
+    return get();
+}
+
+template <typename T>
+iosp::interprocess_shared_ptr<T>::operator bool() const noexcept
+{
+    return offset != 0;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::get() const noexcept -> T*
+{
+    return offset ? control()->object() : nullptr;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::use_count() const noexcept -> std::size_t
+{
+    return offset ? control()->strong_ref.load(std::memory_order_relaxed) : 0;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::share_with_process() const noexcept -> std::uint64_t
+{
+    if(offset)
+        control()->strong_ref.fetch_add(1, std::memory_order_relaxed);
+    return offset;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::reset() noexcept -> void
+{
+    if(offset && control()->strong_ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        control()->object()->~T();
+        control()->~interprocess_control_block<T>();
+        segment->deallocate(offset);
+    }
+    segment = nullptr;
+    offset = 0;
+}
+
+template <typename T>
+auto iosp::interprocess_shared_ptr<T>::swap(interprocess_shared_ptr& other) noexcept -> void
+{
+    std::swap(segment, other.segment);
+    std::swap(offset, other.offset);
+}
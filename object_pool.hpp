@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+// Recycling pool for objects that are expensive to build. Handles are ordinary iosp::unique_ptr and
+// iosp::shared_ptr whose deleter hands the object, still constructed, back to a free list of the
+// releasing thread. The pool must outlive every handle it gave out, like a memory_resource does
+
+namespace iosp { // implementation of smart pointers
+    template<typename T>
+    class object_pool;
+
+    template<typename T>
+    struct pool_deleter;
+}
+
+template<typename T>
+struct iosp::pool_deleter
+{
+    iosp::object_pool<T>* pool = nullptr;
+
+    auto operator()(T* p) const noexcept -> void {
+        if(p)
+            pool->recycle(p);
+    }
+};
+
+template<typename T>
+struct pool_thread_cache
+{
+    struct entry
+    {
+        std::size_t pool_id;
+        std::vector<T*> free;
+        std::ptrdiff_t in_use = 0; // acquired minus released on this thread, negative when others acquired
+        std::ptrdiff_t peak_in_use = 0; // since the last trim
+    };
+
+    std::vector<entry> entries;
+    entry* last = nullptr;
+
+    auto find(std::size_t pool_id) -> entry& {
+        if(last && last->pool_id == pool_id)
+            return *last;
+        auto it = std::find_if(entries.begin(), entries.end(), [&](const entry& e) { return e.pool_id == pool_id; });
+        if(it == entries.end()) {
+            entries.push_back(entry{pool_id, {}});
+            it = entries.end() - 1;
+        }
+        return *(last = &*it);
+    }
+    auto drop(std::size_t pool_id) -> void {
+        auto it = std::find_if(entries.begin(), entries.end(), [&](const entry& e) { return e.pool_id == pool_id; });
+        if(it == entries.end())
+            return;
+        for(T* p : it->free)
+            delete p;
+        entries.erase(it);
+        last = nullptr;
+    }
+    ~pool_thread_cache() {
+        for(entry& e : entries)
+            for(T* p : e.free)
+                delete p;
+    }
+
+    static auto local() -> pool_thread_cache& {
+        static thread_local pool_thread_cache cache;
+        return cache;
+    }
+};
+
+inline std::atomic_size_t pool_next_id{1}; // ids instead of addresses, a new pool may reuse a dead one's address
+
+template<typename T>
+class iosp::object_pool
+{
+public:
+    using factory_type = std::function<T*()>;
+    using reset_type = std::function<void(T&)>;
+    using unique_handle = iosp::unique_ptr<T, iosp::pool_deleter<T>>;
+
+private:
+    friend struct iosp::pool_deleter<T>;
+
+    const std::size_t id = pool_next_id.fetch_add(1, std::memory_order_relaxed);
+    factory_type factory;
+    reset_type reset_hook;
+    std::size_t max_cached; // per thread, releases beyond it are destroyed
+    std::atomic_size_t constructed{0};
+    std::atomic_size_t reused{0};
+
+    auto recycle(T* p) noexcept -> void;
+
+public:
+    // Constructors && Destructor
+    explicit object_pool(std::size_t _Max_cached = 64,
+                         factory_type _Factory = [] { return new T(); }, reset_type _Reset = nullptr);
+    object_pool(const object_pool&) = delete;
+    ~object_pool(); // frees the calling thread's cache, other threads free theirs when they exit
+
+    // Operators
+    auto operator=(const object_pool&) -> object_pool& = delete;
+
+    // Members
+    _NODISCARD auto acquire() -> unique_handle;
+    _NODISCARD auto acquire_shared() -> iosp::shared_ptr<T>;
+    auto trim() noexcept -> std::size_t; // shrinks this thread's free list to the spares its high water mark needed
+    _NODISCARD auto cached() const noexcept -> std::size_t; // on the calling thread
+    _NODISCARD auto constructed_count() const noexcept -> std::size_t;
+    _NODISCARD auto reused_count() const noexcept -> std::size_t;
+};
+
+template <typename T>
+iosp::object_pool<T>::object_pool(std::size_t _Max_cached, factory_type _Factory, reset_type _Reset)
+    : factory(std::move(_Factory)), reset_hook(std::move(_Reset)), max_cached(_Max_cached) {}
+
+template <typename T>
+iosp::object_pool<T>::~object_pool()
+{
+    pool_thread_cache<T>::local().drop(id);
+}
+
+template <typename T>
+auto iosp::object_pool<T>::acquire() -> unique_handle
+{
+    auto& cache = pool_thread_cache<T>::local();
+    T* p = nullptr;
+    if(auto& e = cache.find(id); !e.free.empty()) {
+        p = e.free.back();
+        e.free.pop_back();
+        reused.fetch_add(1, std::memory_order_relaxed);
+    }
+    if(!p) {
+        p = factory();
+        constructed.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto& e = cache.find(id); // the factory may have used other pools and moved this thread's entries
+    e.peak_in_use = std::max(e.peak_in_use, ++e.in_use);
+    return unique_handle(p, iosp::pool_deleter<T>{this});
+}
+
+template <typename T>
+auto iosp::object_pool<T>::acquire_shared() -> iosp::shared_ptr<T>
+{
+    return iosp::shared_ptr<T>(acquire()); // the deleter moves into the control block
+}
+
+template <typename T>
+auto iosp::object_pool<T>::recycle(T* p) noexcept -> void
+{
+    try {
+        auto& cache = pool_thread_cache<T>::local();
+        auto& e = cache.find(id);
+        e.in_use--;
+        if(e.free.size() >= max_cached) {
+            delete p;
+            return;
+        }
+        if(reset_hook)
+            reset_hook(*p);
+        cache.find(id).free.push_back(p); // looked up again, the hook may have moved the entries
+    } catch(...) {
+        delete p; // a failed reset or no memory for the free list, the object is not worth keeping
+    }
+}
+
+template <typename T>
+auto iosp::object_pool<T>::trim() noexcept -> std::size_t
+{
+    auto& e = pool_thread_cache<T>::local().find(id);
+    std::size_t keep = static_cast<std::size_t>(std::max<std::ptrdiff_t>(0, e.peak_in_use - e.in_use));
+    std::size_t trimmed = 0;
+    while(e.free.size() > keep) {
+        delete e.free.back();
+        e.free.pop_back();
+        trimmed++;
+    }
+    e.peak_in_use = std::max<std::ptrdiff_t>(0, e.in_use);
+    return trimmed;
+}
+
+template <typename T>
+auto iosp::object_pool<T>::cached() const noexcept -> std::size_t
+{
+    return pool_thread_cache<T>::local().find(id).free.size();
+}
+
+template <typename T>
+auto iosp::object_pool<T>::constructed_count() const noexcept -> std::size_t
+{
+    return constructed.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+auto iosp::object_pool<T>::reused_count() const noexcept -> std::size_t
+{
+    return reused.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+// Bulk release of a range of iosp::shared_ptr across several threads, each resetting its own slice.
+// An object shared between slices is fine: the decrements are atomic and only the thread that takes
+// its count to zero destroys it. The range is left holding empty pointers. Unlike release_range
+// nothing is sorted; a cache being evicted is mostly distinct owners, where sorting costs far more
+// than the decrements it would merge
+
+namespace iosp { // implementation of smart pointers
+    template<typename ForwardIt>
+    auto parallel_destroy(ForwardIt first, ForwardIt last, std::size_t threads = 0) -> void; // 0: one per hardware thread
+}
+
+template<typename ForwardIt>
+auto iosp::parallel_destroy(ForwardIt first, ForwardIt last, std::size_t threads) -> void
+{
+    constexpr std::size_t min_slice = 1 << 14; // below this a thread costs more than it saves
+
+    std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max<std::size_t>(1, count / min_slice));
+
+    auto release_slice = [](ForwardIt begin, ForwardIt end) noexcept {
+        for(; begin != end; ++begin)
+            begin->reset();
+    };
+    if(threads <= 1) {
+        release_slice(first, last);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    std::size_t slice = count / threads;
+    ForwardIt begin = first;
+    for(std::size_t t = 0; t + 1 < threads; t++) {
+        ForwardIt end = std::next(begin, static_cast<std::ptrdiff_t>(slice));
+        try {
+            workers.emplace_back(release_slice, begin, end);
+        } catch(...) {
+            release_slice(begin, end); // could not start a thread, this one does the slice
+        }
+        begin = end;
+    }
+    release_slice(begin, last); // the calling thread takes the last slice and the remainder
+    for(auto& w : workers)
+        w.join();
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+namespace iosp { // implementation of smart pointers
+    class rcu_read_guard;
+
+    template<typename T>
+    class rcu_ptr;
+}
+
+// Epoch based grace period tracking shared by every rcu_ptr in the process.
+// Each reader thread owns one cache line sized record holding the global epoch it observed
+// when it entered its read-side section (0 while outside). A writer retires the old version
+// at epoch e and may free it once every active record shows an epoch newer than e
+struct rcu_domain
+{
+    struct alignas(64) reader_record
+    {
+        std::atomic_uint64_t epoch{0};
+        std::atomic_bool in_use{true};
+        reader_record* next = nullptr;
+        size_t nesting = 0; // only touched by the owning thread
+    };
+
+    std::atomic_uint64_t global_epoch{1};
+    std::atomic<reader_record*> records{nullptr};
+
+    static auto instance() -> rcu_domain& {
+        static rcu_domain domain;
+        return domain;
+    }
+
+    // records are never freed, a thread that exits hands its record to the next new reader
+    auto acquire_record() -> reader_record* {
+        for(reader_record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if(!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true))
+                return r;
+        }
+        reader_record* r = new reader_record();
+        r->next = records.load(std::memory_order_relaxed);
+        while(!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+        return r;
+    }
+
+    // oldest epoch still observed by a reader, or max if nobody is inside a read-side section
+    auto min_active_epoch() const noexcept -> std::uint64_t {
+        std::uint64_t min = std::numeric_limits<std::uint64_t>::max();
+        for(reader_record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            std::uint64_t e = r->epoch.load();
+            if(e != 0 && e < min)
+                min = e;
+        }
+        return min;
+    }
+
+    ~rcu_domain() {
+        reader_record* r = records.load();
+        while(r) {
+            reader_record* next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+};
+
+struct rcu_thread_record
+{
+    rcu_domain::reader_record* record = rcu_domain::instance().acquire_record();
+    ~rcu_thread_record() {
+        record->in_use.store(false, std::memory_order_release);
+    }
+
+    static auto local() -> rcu_domain::reader_record* {
+        thread_local rcu_thread_record self;
+        return self.record;
+    }
+};
+
+// RAII read-side section. Nests freely and never blocks or touches a shared cache line
+class iosp::rcu_read_guard
+{
+    rcu_domain::reader_record* record;
+
+public:
+    rcu_read_guard() noexcept;
+    rcu_read_guard(const rcu_read_guard&) = delete;
+    auto operator=(const rcu_read_guard&) -> rcu_read_guard& = delete;
+    ~rcu_read_guard();
+};
+
+inline iosp::rcu_read_guard::rcu_read_guard() noexcept
+{
+    record = rcu_thread_record::local();
+    if(record->nesting++ == 0) {
+        // acquire pairs with the writer's bump: having read the bumped epoch we also see the pointer
+        // it published before bumping. seq_cst store against the seq_cst load in read(): the writer's
+        // scan either sees this epoch or we see its new pointer
+        std::uint64_t epoch = rcu_domain::instance().global_epoch.load(std::memory_order_acquire);
+        record->epoch.store(epoch, std::memory_order_seq_cst);
+    }
+}
+
+inline iosp::rcu_read_guard::~rcu_read_guard()
+{
+    if(--record->nesting == 0)
+        record->epoch.store(0, std::memory_order_release);
+}
+
+// Read-mostly pointer: readers get a raw pointer inside an rcu_read_guard without touching any
+// reference count, writers publish a new shared_ptr version and old versions are released once
+// every reader that could still see them has left its read-side section
+template<typename T>
+class iosp::rcu_ptr
+{
+    std::atomic<T*> current{nullptr};
+    iosp::shared_ptr<T> owner; // keeps the published version alive, guarded by write_mutex
+    std::vector<std::pair<std::uint64_t, iosp::shared_ptr<T>>> retired;
+    mutable std::mutex write_mutex;
+
+public:
+    // Constructors && Destructor
+    rcu_ptr() noexcept = default;
+    explicit rcu_ptr(iosp::shared_ptr<T>&& s) noexcept;
+    rcu_ptr(const rcu_ptr&) = delete;
+    ~rcu_ptr();
+
+    // Operators
+    auto operator=(const rcu_ptr&) -> rcu_ptr& = delete;
+
+    // Members
+    _NODISCARD auto read(const iosp::rcu_read_guard&) const noexcept -> const T*; // valid until the guard ends
+    _NODISCARD auto load() const -> iosp::shared_ptr<T>; // owning copy for use outside a read-side section
+    auto update(iosp::shared_ptr<T> next) -> void;
+    auto reclaim() -> std::size_t; // frees retired versions whose grace period has passed, never blocks
+    auto synchronize() -> void; // waits until every retired version can be freed
+    _NODISCARD auto retired_count() const -> std::size_t;
+};
+
+template <typename T>
+iosp::rcu_ptr<T>::rcu_ptr(iosp::shared_ptr<T>&& s) noexcept : owner(std::move(s))
+{
+    current.store(owner.get(), std::memory_order_release);
+}
+
+template <typename T>
+iosp::rcu_ptr<T>::~rcu_ptr()
+{
+    synchronize();
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::read(const iosp::rcu_read_guard&) const noexcept -> const T*
+{
+    return current.load(std::memory_order_seq_cst);
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::load() const -> iosp::shared_ptr<T>
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return owner;
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::update(iosp::shared_ptr<T> next) -> void
+{
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        current.store(next.get());
+        // readers entering after this bump observe the new pointer, so the old version only has
+        // to outlive readers whose recorded epoch is at most the value we bumped from
+        std::uint64_t epoch = rcu_domain::instance().global_epoch.fetch_add(1);
+        retired.emplace_back(epoch, std::move(owner));
+        owner = std::move(next);
+    }
+    reclaim();
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::reclaim() -> std::size_t
+{
+    std::vector<iosp::shared_ptr<T>> expired; // released outside the lock, destructors may be slow
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        std::uint64_t min = rcu_domain::instance().min_active_epoch();
+        size_t kept = 0;
+        for(auto& r : retired) {
+            if(r.first < min)
+                expired.push_back(std::move(r.second));
+            else
+                retired[kept++] = std::move(r);
+        }
+        retired.resize(kept);
+    }
+    return expired.size();
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::synchronize() -> void
+{
+    assert(rcu_thread_record::local()->nesting == 0 && "synchronize() inside a read-side section never returns");
+    reclaim();
+    while(retired_count() != 0) {
+        std::this_thread::yield();
+        reclaim();
+    }
+}
+
+template <typename T>
+auto iosp::rcu_ptr<T>::retired_count() const -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return retired.size();
+}
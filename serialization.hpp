@@ -0,0 +1,302 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "unique_ptr.hpp"
+#include "shared_ptr.hpp"
+
+// Binary snapshots of object graphs built from iosp::shared_ptr and iosp::unique_ptr.
+// A shared object is written once, the first time it is reached; every later shared_ptr to it
+// is written as a back reference, so DAGs (and cycles) keep their sharing when loaded again.
+// The writer keeps every shared object it wrote alive until it is destroyed, so a temporary freed
+// mid stream cannot hand its address to a later object and come back as its back reference.
+//
+// User types opt in with one member used for both directions:
+//     template<typename Archive> void serialize(Archive& ar) { ar(a, b, children); }
+// Arithmetic values are stored in native byte order, loaded types must be default constructible.
+//
+// Format: "IOSPSNAP" + version, then the values in the order they are visited. Lengths and
+// pointer tags are LEB128 varints; a shared_ptr tag is 0 for null, 1 for a new object that
+// follows inline, id + 2 for a back reference to the id-th object written
+
+namespace iosp { // implementation of smart pointers
+    class archive_writer;
+    class archive_reader;
+}
+
+template<typename T>
+struct is_iosp_shared_ptr : std::false_type{};
+template<typename T>
+struct is_iosp_shared_ptr<iosp::shared_ptr<T>> : std::true_type{};
+
+template<typename T>
+struct is_iosp_unique_ptr : std::false_type{};
+template<typename T>
+struct is_iosp_unique_ptr<iosp::unique_ptr<T, std::default_delete<T>>> : std::true_type{};
+
+template<typename T>
+struct is_std_vector : std::false_type{};
+template<typename T, typename A>
+struct is_std_vector<std::vector<T, A>> : std::true_type{};
+
+struct archive_format
+{
+    static constexpr char magic[8] = {'I', 'O', 'S', 'P', 'S', 'N', 'A', 'P'};
+    static constexpr std::uint8_t version = 1;
+    static constexpr std::uint64_t null_tag = 0;
+    static constexpr std::uint64_t new_object_tag = 1;
+    static constexpr std::uint64_t first_reference_tag = 2;
+};
+
+class iosp::archive_writer
+{
+    // aliasing shared_ptrs into the same owner point at different objects, both halves identify one.
+    // The type tells apart an object and its first member, which share both addresses
+    struct object_key
+    {
+        const void* owner;
+        const void* object;
+        const std::type_info* type;
+        auto operator==(const object_key& o) const noexcept -> bool { return owner == o.owner && object == o.object && *type == *o.type; }
+    };
+    struct object_key_hash
+    {
+        auto operator()(const object_key& k) const noexcept -> std::size_t {
+            // owner and object usually sit a few bytes apart, mix them so the pair does not cancel out
+            std::uint64_t h = reinterpret_cast<std::uintptr_t>(k.owner) * 0x9e3779b97f4a7c15ULL;
+            h ^= reinterpret_cast<std::uintptr_t>(k.object) + (h >> 29);
+            return static_cast<std::size_t>(h * 0xbf58476d1ce4e5b9ULL);
+        }
+    };
+
+    std::ostream& out;
+    std::unordered_map<object_key, std::uint64_t, object_key_hash> ids;
+    std::vector<iosp::shared_ptr<const char>> pinned; // pinned[id] owns the object behind that id
+    std::uint64_t references = 0;
+
+public:
+    explicit archive_writer(std::ostream& os);
+    archive_writer(const archive_writer&) = delete;
+    auto operator=(const archive_writer&) -> archive_writer& = delete;
+
+    template<typename... Ts>
+    auto operator()(const Ts&... values) -> archive_writer&;
+
+    _NODISCARD auto shared_objects() const noexcept -> std::uint64_t; // written in full
+    _NODISCARD auto shared_references() const noexcept -> std::uint64_t; // written as back references
+
+private:
+    template<typename T>
+    auto save(const T& value) -> void;
+    auto write_varint(std::uint64_t v) -> void;
+    auto write_bytes(const void* p, std::size_t n) -> void;
+};
+
+class iosp::archive_reader
+{
+    struct loaded_object
+    {
+        iosp::shared_ptr<char> owner; // aliases the object, only kept for its control block
+        const std::type_info* type;
+    };
+
+    std::istream& in;
+    std::vector<loaded_object> objects;
+
+public:
+    explicit archive_reader(std::istream& is);
+    archive_reader(const archive_reader&) = delete;
+    auto operator=(const archive_reader&) -> archive_reader& = delete;
+
+    template<typename... Ts>
+    auto operator()(Ts&... values) -> archive_reader&;
+
+    _NODISCARD auto shared_objects() const noexcept -> std::uint64_t;
+
+private:
+    template<typename T>
+    auto load(T& value) -> void;
+    auto read_varint() -> std::uint64_t;
+    auto read_bytes(void* p, std::size_t n) -> void;
+};
+
+inline iosp::archive_writer::archive_writer(std::ostream& os) : out(os)
+{
+    write_bytes(archive_format::magic, sizeof(archive_format::magic));
+    write_bytes(&archive_format::version, 1);
+}
+
+template <typename... Ts>
+auto iosp::archive_writer::operator()(const Ts&... values) -> archive_writer&
+{
+    (save(values), ...);
+    return *this;
+}
+
+inline auto iosp::archive_writer::shared_objects() const noexcept -> std::uint64_t
+{
+    return ids.size();
+}
+
+inline auto iosp::archive_writer::shared_references() const noexcept -> std::uint64_t
+{
+    return references;
+}
+
+template <typename T>
+auto iosp::archive_writer::save(const T& value) -> void
+{
+    if constexpr(std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        write_bytes(&value, sizeof(T));
+    } else if constexpr(std::is_same_v<T, std::string>) {
+        write_varint(value.size());
+        write_bytes(value.data(), value.size());
+    } else if constexpr(is_std_vector<T>::value) {
+        write_varint(value.size());
+        if constexpr(std::is_arithmetic_v<typename T::value_type>) {
+            write_bytes(value.data(), value.size() * sizeof(typename T::value_type));
+        } else {
+            for(const auto& v : value)
+                save(v);
+        }
+    } else if constexpr(is_iosp_shared_ptr<T>::value) {
+        if(!value) {
+            write_varint(archive_format::null_tag);
+            return;
+        }
+        using U = std::remove_reference_t<decltype(*value)>; // the static type, the one the reader checks
+        auto [it, inserted] = ids.try_emplace(object_key{value.owner_id(), value.get(), &typeid(U)}, ids.size());
+        if(!inserted) {
+            references++;
+            write_varint(it->second + archive_format::first_reference_tag);
+            return;
+        }
+        try {
+            pinned.emplace_back(value, reinterpret_cast<const char*>(value.get()));
+        } catch(...) {
+            ids.erase(it);
+            throw;
+        }
+        write_varint(archive_format::new_object_tag);
+        save(*value); // registered before recursing, so cycles end in a back reference
+    } else if constexpr(is_iosp_unique_ptr<T>::value) {
+        write_varint(value ? archive_format::new_object_tag : archive_format::null_tag);
+        if(value)
+            save(*value);
+    } else {
+        const_cast<T&>(value).serialize(*this);
+    }
+}
+
+inline auto iosp::archive_writer::write_varint(std::uint64_t v) -> void
+{
+    unsigned char buffer[10];
+    std::size_t n = 0;
+    do {
+        unsigned char byte = v & 0x7f;
+        v >>= 7;
+        buffer[n++] = byte | (v ? 0x80 : 0);
+    } while(v);
+    write_bytes(buffer, n);
+}
+
+inline auto iosp::archive_writer::write_bytes(const void* p, std::size_t n) -> void
+{
+    // straight to the stream buffer, an ostream::write sentry per varint dominated the write time
+    if(out.rdbuf()->sputn(static_cast<const char*>(p), static_cast<std::streamsize>(n)) != static_cast<std::streamsize>(n))
+        throw std::runtime_error("archive_writer: write failed");
+}
+
+inline iosp::archive_reader::archive_reader(std::istream& is) : in(is)
+{
+    char magic[sizeof(archive_format::magic)];
+    std::uint8_t version;
+    read_bytes(magic, sizeof(magic));
+    read_bytes(&version, 1);
+    if(std::memcmp(magic, archive_format::magic, sizeof(magic)) != 0 || version != archive_format::version)
+        throw std::runtime_error("archive_reader: not an iosp snapshot");
+}
+
+template <typename... Ts>
+auto iosp::archive_reader::operator()(Ts&... values) -> archive_reader&
+{
+    (load(values), ...);
+    return *this;
+}
+
+inline auto iosp::archive_reader::shared_objects() const noexcept -> std::uint64_t
+{
+    return objects.size();
+}
+
+template <typename T>
+auto iosp::archive_reader::load(T& value) -> void
+{
+    if constexpr(std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        read_bytes(&value, sizeof(T));
+    } else if constexpr(std::is_same_v<T, std::string>) {
+        value.resize(read_varint());
+        read_bytes(value.data(), value.size());
+    } else if constexpr(is_std_vector<T>::value) {
+        value.resize(read_varint());
+        if constexpr(std::is_arithmetic_v<typename T::value_type>) {
+            read_bytes(value.data(), value.size() * sizeof(typename T::value_type));
+        } else {
+            for(auto& v : value)
+                load(v);
+        }
+    } else if constexpr(is_iosp_shared_ptr<T>::value) {
+        using U = std::remove_const_t<std::remove_reference_t<decltype(*value)>>;
+        std::uint64_t tag = read_varint();
+        if(tag == archive_format::null_tag) {
+            value = nullptr;
+        } else if(tag == archive_format::new_object_tag) {
+            iosp::shared_ptr<U> object = iosp::make_shared<U>(); // fused, one allocation per shared object
+            objects.push_back({iosp::shared_ptr<char>(object, reinterpret_cast<char*>(object.get())), &typeid(U)});
+            value = object; // before loading the members, a cycle back to it finds it complete enough
+            load(*object);
+        } else {
+            std::uint64_t id = tag - archive_format::first_reference_tag;
+            if(id >= objects.size() || *objects[id].type != typeid(U))
+                throw std::runtime_error("archive_reader: bad back reference");
+            value = iosp::shared_ptr<U>(objects[id].owner, reinterpret_cast<U*>(objects[id].owner.get()));
+        }
+    } else if constexpr(is_iosp_unique_ptr<T>::value) {
+        using U = std::remove_reference_t<decltype(*value)>;
+        if(read_varint() == archive_format::null_tag) {
+            value = nullptr;
+        } else {
+            value = iosp::make_unique<U>();
+            load(*value);
+        }
+    } else {
+        value.serialize(*this);
+    }
+}
+
+inline auto iosp::archive_reader::read_varint() -> std::uint64_t
+{
+    std::uint64_t v = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+        unsigned char byte;
+        read_bytes(&byte, 1);
+        v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+            return v;
+    }
+    throw std::runtime_error("archive_reader: malformed varint");
+}
+
+inline auto iosp::archive_reader::read_bytes(void* p, std::size_t n) -> void
+{
+    if(in.rdbuf()->sgetn(static_cast<char*>(p), static_cast<std::streamsize>(n)) != static_cast<std::streamsize>(n))
+        throw std::runtime_error("archive_reader: unexpected end of snapshot");
+}
@@ -1,21 +1,23 @@
 #pragma once
 #include <type_traits>
+#include <algorithm>
 #include <atomic>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
+#include <vector>
 #include "weak_ptr.hpp"
 
 #define DEBUG
 
-namespace iosp { // implementation of smart pointers
-    template<typename Ptr>
-    class shared_ptr;
-
-    template<typename T, typename... Args>
-    _NODISCARD auto make_shared(Args&&... args) -> iosp::shared_ptr<T>;
-    template<typename T>
-    _NODISCARD auto make_shared(size_t size) -> iosp::shared_ptr<T>;
-}
+// ThreadSanitizer does not model standalone fences
+#if defined(__SANITIZE_THREAD__)
+#define IOSP_TSAN
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define IOSP_TSAN
+#endif
+#endif
 
 template<typename, typename = void>
 struct is_allocator : std::false_type{};
@@ -27,6 +29,45 @@ struct is_allocator<A, std::void_t<
     decltype(std::declval<A&>().deallocate(std::declval<typename A::value_type*>(), std::size_t{}))
 >> : std::true_type{};
 
+namespace iosp { // implementation of smart pointers
+    template<typename Ptr>
+    class shared_ptr;
+    template<typename T>
+    class compact_shared_ptr;
+    template<typename T, typename Hash, typename KeyEqual>
+    class intern_table;
+
+    struct lazy_t { explicit lazy_t() = default; };
+    // Adopt a pointer without allocating a control block until it is first copied or aliased.
+    // Threads copying the same lazy owner race to install a block and the losers free theirs.
+    // The copy is still noexcept, failing to allocate that first block terminates
+    inline constexpr lazy_t lazy{};
+
+    template<typename T, typename... Args>
+    _NODISCARD auto make_shared(Args&&... args) -> iosp::shared_ptr<T>;
+    template<typename T>
+    _NODISCARD auto make_shared(size_t size) -> iosp::shared_ptr<T>;
+    template<typename T, typename Init>
+    _NODISCARD auto make_shared_group(size_t count, Init init) -> std::vector<iosp::shared_ptr<T>>;
+    template<typename T>
+    _NODISCARD auto make_shared_group(size_t count) -> std::vector<iosp::shared_ptr<T>>;
+    // Never freed: copies, assignments and destruction only read the count, they never write it
+    template<typename T, typename... Args>
+    _NODISCARD auto make_immortal_shared(Args&&... args) -> iosp::shared_ptr<T>;
+    template<typename T, typename Allocator, typename... Args>
+    _NODISCARD auto allocate_shared(const Allocator& alloc, Args&&... args) -> std::enable_if_t<is_allocator<Allocator>::value, iosp::shared_ptr<T>>;
+    template<typename T, typename... Args>
+    _NODISCARD auto allocate_shared(std::pmr::memory_resource* resource, Args&&... args) -> iosp::shared_ptr<T>;
+
+    // Batched reference counting: n copies for one atomic add, one atomic sub per distinct owner
+    template<typename T, typename OutputIt>
+    auto share_into(const iosp::shared_ptr<T>& s, size_t n, OutputIt out) -> OutputIt;
+    template<typename T>
+    _NODISCARD auto share_n(const iosp::shared_ptr<T>& s, size_t n) -> std::vector<iosp::shared_ptr<T>>;
+    template<typename ForwardIt>
+    auto release_range(ForwardIt first, ForwardIt last) -> void;
+}
+
 struct control_block;
 template<typename Ptr, typename Deleter = std::default_delete<Ptr>, typename Allocator = void>
 struct object_owner_alloc;
@@ -34,24 +75,68 @@ template<typename Ptr, typename Deleter = std::default_delete<Ptr>>
 struct object_owner;
 template<typename T>
 struct make_shared_control_block;
+template<typename T>
+struct make_shared_group_control_block;
+template<typename T, typename Allocator>
+struct allocate_shared_control_block;
 
 struct control_block
 {
+    // Immortal blocks have the top bit set in both counts. The one in strong_ref keeps paths that count
+    // anyway from ever reaching zero; the one in weak_ref is what gets tested, that word is not written
+    // by copies, so the check never waits behind a locked add on strong_ref
+    static constexpr size_t immortal_ref = size_t(1) << (sizeof(size_t) * 8 - 1);
+
     std::atomic_size_t strong_ref{1};
     std::atomic_size_t weak_ref{0};
+    auto is_immortal() const noexcept -> bool {
+        return weak_ref.load(std::memory_order_relaxed) & immortal_ref;
+    }
+
+    // A new reference is always copied from one that is alive, so the increment orders nothing.
+    // Dropping one releases this owner's writes to the object; whoever drops the last acquires
+    // all of them before destroying it
+    auto add_ref(size_t n = 1) noexcept -> void {
+        strong_ref.fetch_add(n, std::memory_order_relaxed);
+    }
+    _NODISCARD auto drop_ref(size_t n = 1) noexcept -> bool { // true when it dropped the last ones
+        if(strong_ref.fetch_sub(n, std::memory_order_release) != n)
+            return false;
+#ifdef IOSP_TSAN
+        (void)strong_ref.load(std::memory_order_acquire); // same edge, through the release sequence of the decrements
+#else
+        std::atomic_thread_fence(std::memory_order_acquire);
+#endif
+        return true;
+    }
     virtual ~control_block() = default;
     virtual auto destroy() -> void = 0;
+    virtual auto identity() const noexcept -> const void* { return this; } // what owner_before compares
     control_block() = default;
     control_block(const control_block&) = delete;
     control_block& operator=(const control_block&) = delete;
 };
 
+// Stands in for the control block of a shared_ptr adopted with iosp::lazy that has never been shared.
+// Its counters are never touched, the owning shared_ptr deletes the pointer itself
+struct lazy_control_block : control_block
+{
+    void destroy() override {}
+};
+
+inline lazy_control_block lazy_owner;
+
 template<typename T>
 struct make_shared_control_block : control_block
 {
+    static constexpr auto object_offset() -> size_t {
+        return (sizeof(make_shared_control_block) + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+    auto object() noexcept -> T* { // the object always sits at a fixed offset from its control block
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + object_offset());
+    }
     void destroy() {
-        T* obj = reinterpret_cast<T*>(reinterpret_cast<char*>(this) + sizeof(make_shared_control_block));
-        obj->~T();
+        object()->~T();
         this->~control_block();
         ::operator delete(this);
     }
@@ -60,15 +145,134 @@ struct make_shared_control_block : control_block
 template<typename T, typename... Args>
 _NODISCARD auto iosp::make_shared(Args&&... args) -> iosp::shared_ptr<T>
 {
-    size_t cb_size = sizeof(make_shared_control_block<T>);
-    size_t obj_size = sizeof(T);
-    void* mem = ::operator new (cb_size+obj_size);
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned types are not supported");
+    void* mem = ::operator new (make_shared_control_block<T>::object_offset() + sizeof(T));
     make_shared_control_block<T>* cb;
     cb = new (mem) make_shared_control_block<T>();
-    T* obj = new (reinterpret_cast<char*>(mem) + cb_size) T(std::forward<Args>(args)...); 
-    return iosp::shared_ptr<T>(obj, cb);
+    try {
+        new (cb->object()) T(std::forward<Args>(args)...);
+    } catch(...) {
+        cb->~make_shared_control_block<T>();
+        ::operator delete(mem);
+        throw;
+    }
+    return iosp::shared_ptr<T>(cb->object(), static_cast<control_block*>(cb));
+};
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_immortal_shared(Args&&... args) -> iosp::shared_ptr<T>
+{
+    iosp::shared_ptr<T> s = iosp::make_shared<T>(std::forward<Args>(args)...);
+    s.cb->strong_ref.store(control_block::immortal_ref, std::memory_order_relaxed); // not shared with anyone yet
+    s.cb->weak_ref.store(control_block::immortal_ref, std::memory_order_relaxed);
+    return s;
+}
+
+// N objects laid out contiguously right after the control block, destroyed together
+template<typename T>
+struct make_shared_group_control_block : control_block
+{
+    size_t count;
+
+    explicit make_shared_group_control_block(size_t n) : count(n) {}
+
+    static constexpr auto objects_offset() -> size_t {
+        return (sizeof(make_shared_group_control_block) + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+    auto objects() -> T* {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + objects_offset());
+    }
+    void destroy() override {
+        T* objs = objects();
+        for(size_t i = count; i > 0; i--)
+            objs[i-1].~T();
+        this->~make_shared_group_control_block();
+        ::operator delete(this);
+    }
 };
 
+template<typename T, typename Init>
+_NODISCARD auto iosp::make_shared_group(size_t count, Init init) -> std::vector<iosp::shared_ptr<T>>
+{
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned types are not supported");
+    using _CB = make_shared_group_control_block<T>;
+
+    std::vector<iosp::shared_ptr<T>> group;
+    if(count == 0)
+        return group;
+    group.reserve(count);
+
+    void* mem = ::operator new (_CB::objects_offset() + count*sizeof(T)); // one allocation for the counters and every object
+    _CB* cb = new (mem) _CB(0);
+    T* objs = cb->objects();
+    try {
+        for(; cb->count < count; cb->count++)
+            new (objs + cb->count) T(init(cb->count));
+    } catch(...) {
+        cb->destroy(); // only the cb->count objects constructed so far are destroyed
+        throw;
+    }
+
+    group.push_back(iosp::shared_ptr<T>(objs, static_cast<control_block*>(cb)));
+    for(size_t i = 1; i < count; i++)
+        group.push_back(iosp::shared_ptr<T>(group.front(), objs + i)); // aliasing, shares the single control block
+    return group;
+}
+
+template<typename T>
+_NODISCARD auto iosp::make_shared_group(size_t count) -> std::vector<iosp::shared_ptr<T>>
+{
+    return iosp::make_shared_group<T>(count, [](size_t) { return T(); });
+}
+
+// Control block and object in one allocation obtained from a user allocator
+template<typename T, typename Allocator>
+struct allocate_shared_control_block : control_block
+{
+    using Alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<allocate_shared_control_block>;
+    using Object_Alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    Alloc allocator;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    explicit allocate_shared_control_block(const Alloc& a) : allocator(a) {}
+    auto object() -> T* {
+        return reinterpret_cast<T*>(storage);
+    }
+    void destroy() override {
+        Object_Alloc object_alloc(allocator);
+        std::allocator_traits<Object_Alloc>::destroy(object_alloc, object());
+
+        Alloc a(allocator); // the block cannot deallocate itself with an allocator it has already destroyed
+        std::allocator_traits<Alloc>::destroy(a, this);
+        std::allocator_traits<Alloc>::deallocate(a, this, 1);
+    }
+};
+
+template<typename T, typename Allocator, typename... Args>
+_NODISCARD auto iosp::allocate_shared(const Allocator& alloc, Args&&... args) -> std::enable_if_t<is_allocator<Allocator>::value, iosp::shared_ptr<T>>
+{
+    using _CB = allocate_shared_control_block<T, Allocator>;
+    typename _CB::Alloc alloc_cb(alloc);
+    _CB* cb = std::allocator_traits<typename _CB::Alloc>::allocate(alloc_cb, 1);
+    new (cb) _CB(alloc_cb);
+    try {
+        // constructing through the allocator lets uses-allocator types (pmr containers) pick it up too
+        typename _CB::Object_Alloc object_alloc(alloc_cb);
+        std::allocator_traits<typename _CB::Object_Alloc>::construct(object_alloc, cb->object(), std::forward<Args>(args)...);
+    } catch(...) {
+        cb->~_CB();
+        std::allocator_traits<typename _CB::Alloc>::deallocate(alloc_cb, cb, 1);
+        throw;
+    }
+    return iosp::shared_ptr<T>(cb->object(), static_cast<control_block*>(cb));
+}
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::allocate_shared(std::pmr::memory_resource* resource, Args&&... args) -> iosp::shared_ptr<T>
+{
+    return iosp::allocate_shared<T>(std::pmr::polymorphic_allocator<std::byte>(resource), std::forward<Args>(args)...);
+}
+
 #ifdef DEBUG
     static size_t alloc_count = 0;
 #endif
@@ -90,8 +294,9 @@ struct object_owner_alloc : public control_block
         }
 
         using _Alloc_Traits = std::allocator_traits<Alloc>;
-        _Alloc_Traits::destroy(allocator, this);
-        _Alloc_Traits::deallocate(allocator, this, 1);
+        Alloc a(allocator); // the block cannot deallocate itself with an allocator it has already destroyed
+        _Alloc_Traits::destroy(a, this);
+        _Alloc_Traits::deallocate(a, this, 1);
     }
 };
 
@@ -112,14 +317,30 @@ struct object_owner : public control_block
     }
 };
 
+// Allocated by the first share of a pointer adopted with iosp::lazy. It keeps answering with the
+// adopted pointer, the identity the owner had before the block existed, so a lazy key already
+// sitting in an owner_before ordered set does not move when it is copied
+template<typename Ptr>
+struct lazy_object_owner : public object_owner<Ptr>
+{
+    const void* adopted;
+
+    explicit lazy_object_owner(Ptr* p) : object_owner<Ptr>(p, std::default_delete<Ptr>{}), adopted(p) {}
+    auto identity() const noexcept -> const void* override { return adopted; }
+};
+
 template<typename Ptr>
 class iosp::shared_ptr
 {
     Ptr* pointer;
-    control_block* cb;
+    mutable control_block* cb; // &lazy_owner until a lazily adopted pointer is first shared, then set once by CAS
 
     template<typename>
     friend class shared_ptr; // Every instantiation of shared_ptr is a friend of every other instantiation
+    template<typename>
+    friend class compact_shared_ptr;
+    template<typename, typename, typename>
+    friend class intern_table;
 
 public:
     // Constructors && Destructor
@@ -128,6 +349,8 @@ public:
 
     template<typename Y>
     explicit shared_ptr(Y* _Ptr);
+    template<typename Y>
+    shared_ptr(Y* _Ptr, iosp::lazy_t) noexcept; // no control block until copied or aliased
     // checks if Deleter is the control_block so the compiler knows if it has to choose this or the private constructor
     template <typename Y, typename Deleter, typename std::enable_if_t<!std::is_base_of_v<control_block, std::remove_pointer_t<Deleter>>>>
     shared_ptr(Y* _Ptr, Deleter _Dltr);
@@ -141,6 +364,12 @@ public:
     template<typename Deleter, typename Allocator>
     shared_ptr(std::nullptr_t _Ptr, Deleter _Dltr, Allocator _Alloc);
 
+    // std::pmr::memory_resource for the control block, picked at runtime instead of through the Allocator type
+    template<typename Y, typename Deleter, typename Resource, typename = std::enable_if_t<std::is_base_of_v<std::pmr::memory_resource, Resource>>>
+    shared_ptr(Y* _Ptr, Deleter _Dltr, Resource* _Res);
+    template<typename Deleter, typename Resource, typename = std::enable_if_t<std::is_base_of_v<std::pmr::memory_resource, Resource>>>
+    shared_ptr(std::nullptr_t _Ptr, Deleter _Dltr, Resource* _Res);
+
     template<typename Y>
     shared_ptr(const shared_ptr<Y>& s, Ptr* _Ptr) noexcept; // Aliasing constructor
 
@@ -161,8 +390,24 @@ public:
 private:
     template<typename Y>
     shared_ptr(Y* _Ptr, control_block* _CB) : pointer(_Ptr), cb(_CB) {}
+
+    // cb of an owner others may be copying at the same time, one of them may be installing its block
+    auto control() const noexcept -> control_block* { return std::atomic_ref<control_block*>(cb).load(std::memory_order_acquire); }
+    auto is_lazy() const noexcept -> bool { return control() == &lazy_owner; }
+    auto share_control_block() const noexcept -> control_block*; // allocates the control block of a lazy owner
+    auto release_ownership() noexcept -> void; // drops this owner's reference, cb is left dangling
     template<typename T, typename... Args>
     friend auto iosp::make_shared(Args&&... args) -> iosp::shared_ptr<T>;
+    template<typename T, typename... Args>
+    friend auto iosp::make_immortal_shared(Args&&... args) -> iosp::shared_ptr<T>;
+    template<typename T, typename Init>
+    friend auto iosp::make_shared_group(size_t count, Init init) -> std::vector<iosp::shared_ptr<T>>;
+    template<typename T, typename Allocator, typename... Args>
+    friend auto iosp::allocate_shared(const Allocator& alloc, Args&&... args) -> std::enable_if_t<is_allocator<Allocator>::value, iosp::shared_ptr<T>>;
+    template<typename T, typename OutputIt>
+    friend auto iosp::share_into(const iosp::shared_ptr<T>& s, size_t n, OutputIt out) -> OutputIt;
+    template<typename ForwardIt>
+    friend auto iosp::release_range(ForwardIt first, ForwardIt last) -> void;
 public:
     // Operators
     auto operator=(const shared_ptr& s) -> shared_ptr&;
@@ -181,9 +426,10 @@ public:
     // Members
     _NODISCARD auto get() const noexcept -> Ptr*;
     _NODISCARD auto unique() const noexcept -> bool;
-    _NODISCARD auto use_count() const noexcept -> std::size_t;
+    _NODISCARD auto use_count() const noexcept -> std::size_t; // immortal owners report control_block::immortal_ref or more
     template<typename Y>
     _NODISCARD auto owner_before(const shared_ptr<Y>& other) const noexcept -> bool;
+    _NODISCARD auto owner_id() const noexcept -> const void*; // equal for every shared_ptr sharing ownership
     // template<typename Y>
     // _NODISCARD auto owner_before(const iosp::weak_ptr<Y>& other) const noexcept -> bool; // ! NOT IMPLEMENTED YET
     auto reset() noexcept -> void;
@@ -201,12 +447,14 @@ template <typename Ptr>
 iosp::shared_ptr<Ptr>::shared_ptr() noexcept
 {
     pointer = nullptr;
+    cb = nullptr;
 }
 
 template <typename Ptr>
 iosp::shared_ptr<Ptr>::shared_ptr(std::nullptr_t) noexcept
 {
     pointer = nullptr;
+    cb = nullptr;
 }
 
 template <typename Ptr>
@@ -222,6 +470,15 @@ iosp::shared_ptr<Ptr>::shared_ptr(Y *_Ptr)
         cb = nullptr;
 }
 
+template <typename Ptr>
+template <typename Y>
+iosp::shared_ptr<Ptr>::shared_ptr(Y* _Ptr, iosp::lazy_t) noexcept
+{
+    static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
+    pointer = _Ptr;
+    cb = _Ptr ? &lazy_owner : nullptr;
+}
+
 template <typename Ptr>
 template <typename Y, typename Deleter, typename std::enable_if_t<!std::is_base_of_v<control_block, std::remove_pointer_t<Deleter>>>>
 iosp::shared_ptr<Ptr>::shared_ptr(Y *_Ptr, Deleter _Dltr)
@@ -250,7 +507,6 @@ iosp::shared_ptr<Ptr>::shared_ptr(Y* _Ptr, Deleter _Dltr, Allocator _Alloc)
     static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
 
     using _CB = object_owner_alloc<Ptr, Deleter, Allocator>;
-    std::cout << "size of ptr_base " << sizeof(_CB) << std::endl;
     using _Alloc_CB = typename std::allocator_traits<Allocator>::template rebind_alloc<_CB>; // custom allocator is converted to now allocate the control block
                                                                                              // creates a new allocator type that has the same behavior as Allocator
                                                                                              // but changes its value_type to _CB
@@ -288,23 +544,33 @@ iosp::shared_ptr<Ptr>::shared_ptr(std::nullptr_t _Ptr, Deleter _Dltr, Allocator
     }
 }
 
+template <typename Ptr>
+template <typename Y, typename Deleter, typename Resource, typename>
+iosp::shared_ptr<Ptr>::shared_ptr(Y* _Ptr, Deleter _Dltr, Resource* _Res)
+    : shared_ptr(_Ptr, std::move(_Dltr), std::pmr::polymorphic_allocator<std::byte>(_Res)) {}
+
+template <typename Ptr>
+template <typename Deleter, typename Resource, typename>
+iosp::shared_ptr<Ptr>::shared_ptr(std::nullptr_t _Ptr, Deleter _Dltr, Resource* _Res)
+    : shared_ptr(_Ptr, std::move(_Dltr), std::pmr::polymorphic_allocator<std::byte>(_Res)) {}
+
 template <typename Ptr>
 template <typename Y>
 iosp::shared_ptr<Ptr>::shared_ptr(const shared_ptr<Y>& s, Ptr* _Ptr) noexcept
 {
+    cb = s.share_control_block();
     pointer = _Ptr;
-    cb = s.cb;
-    if(cb)
-        cb->strong_ref.fetch_add(1);
+    if(cb && !cb->is_immortal())
+        cb->add_ref();
 }
 
 template <typename Ptr>
 iosp::shared_ptr<Ptr>::shared_ptr(const shared_ptr &s) noexcept
 {
+    cb = s.share_control_block();
     pointer = s.pointer;
-    cb = s.cb;
-    if(cb)
-        cb->strong_ref.fetch_add(1);
+    if(cb && !cb->is_immortal())
+        cb->add_ref();
 }
 
 template <typename Ptr>
@@ -321,8 +587,8 @@ template<typename Y>
 iosp::shared_ptr<Ptr>::shared_ptr(shared_ptr<Y>&& s) noexcept
 {
     static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
+    cb = s.share_control_block(); // a lazy owner of Y must keep deleting through Y*
     pointer = s.pointer;
-    cb = s.cb;
     s.pointer = nullptr;
     s.cb = nullptr;
 }
@@ -347,25 +613,46 @@ iosp::shared_ptr<Ptr>::shared_ptr(iosp::unique_ptr<Y, Deleter> &&u)
 template <typename Ptr>
 iosp::shared_ptr<Ptr>::~shared_ptr()
 {
-    if(cb && cb->strong_ref.fetch_sub(1) == 1) {
-        cb->destroy();
-    }
+    release_ownership();
 }
 
 template <typename Ptr>
-auto iosp::shared_ptr<Ptr>::operator=(const shared_ptr& s) -> shared_ptr&
+auto iosp::shared_ptr<Ptr>::share_control_block() const noexcept -> control_block*
+{
+    control_block* current = control();
+    if(current != &lazy_owner)
+        return current;
+
+    auto* fresh = new lazy_object_owner<Ptr>(pointer);
+    if(std::atomic_ref<control_block*>(cb).compare_exchange_strong(current, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+        return fresh;
+    fresh->pointer = nullptr; // another copy installed its block first, the object stays with that one
+    fresh->destroy();
+    return current;
+}
+
+template <typename Ptr>
+auto iosp::shared_ptr<Ptr>::release_ownership() noexcept -> void
 {
-    if(this != &s) {
-        if(cb && cb->strong_ref.fetch_sub(1) == 1)
+    if(is_lazy()) {
+        if constexpr(iosp::has_deferred_teardown_v<Ptr>)
+            teardown_worklist::run([](void* p) { std::default_delete<Ptr>{}(static_cast<Ptr*>(p)); }, pointer);
+        else
+            std::default_delete<Ptr>{}(pointer);
+    }
+    else if(cb && !cb->is_immortal() && cb->drop_ref()) {
+        if constexpr(iosp::has_deferred_teardown_v<Ptr>)
+            teardown_worklist::run([](void* c) { static_cast<control_block*>(c)->destroy(); }, cb);
+        else
             cb->destroy();
-        
-        pointer = s.pointer;
-        cb = s.cb;
-
-        if(cb)
-            cb->strong_ref.fetch_add(1);
     }
+}
 
+template <typename Ptr>
+auto iosp::shared_ptr<Ptr>::operator=(const shared_ptr& s) -> shared_ptr&
+{
+    // copy first: s may live inside the object this owner is about to release (head = head->next)
+    shared_ptr(s).swap(*this);
     return *this;
 }
 
@@ -374,29 +661,14 @@ template <typename Y>
 auto iosp::shared_ptr<Ptr>::operator=(const shared_ptr<Y>& s) noexcept -> shared_ptr&
 {
     static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
-    if(this != &s) {
-        if(cb && cb->strong_ref.fetch_sub(1) == 1)
-            cb->destroy();
-        
-        pointer = s.pointer;
-        cb = s.cb;
-
-        if(cb)
-            cb->strong_ref.fetch_add(1);
-    }
-
+    shared_ptr(s, s.get()).swap(*this);
     return *this;
 }
 
 template <typename Ptr>
 auto iosp::shared_ptr<Ptr>::operator=(shared_ptr &&s) noexcept -> shared_ptr&
 {
-    if(this != &s) {
-        if(cb && cb->strong_ref.fetch_sub(1) == 1)
-            cb->destroy();
-        pointer = s.pointer;
-        cb = s.cb;
-    }
+    shared_ptr(std::move(s)).swap(*this);
     return *this;
 }
 
@@ -405,15 +677,7 @@ template <typename Y>
 auto iosp::shared_ptr<Ptr>::operator=(shared_ptr<Y>&& s) noexcept -> shared_ptr&
 {
     static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
-    if(this != &s) {
-        if(cb && cb->strong_ref.fetch_sub(1) == 1)
-            cb->destroy();
-        pointer = s.pointer;
-        cb = s.cb;
-
-        s.pointer = nullptr;
-        s.cb = nullptr;
-    }
+    shared_ptr(std::move(s)).swap(*this);
     return *this;
 }
 
@@ -421,22 +685,7 @@ template <typename Ptr>
 template <typename Y, typename Deleter>
 auto iosp::shared_ptr<Ptr>::operator=(unique_ptr<Y, Deleter> &&u) -> shared_ptr&
 {
-    static_assert(std::is_nothrow_move_constructible_v<Deleter>);
-    static_assert(std::is_convertible_v<Y*, Ptr*>, "Pointer type must be convertible to Ptr*");
-
-    if(cb && cb->strong_ref.fetch_sub(1) == 1)
-        cb->destroy();
-
-    auto p = u.release();
-    try {
-        cb = new object_owner<Ptr, Deleter>(p, std::move(u.get_deleter()));
-        pointer = p;
-    } catch(...) {
-        u.get_deleter()(p);
-        cb = nullptr;
-        pointer = nullptr;
-        throw;
-    }
+    shared_ptr(std::move(u)).swap(*this); // on failure u's object is deleted and this keeps its own
     return *this;
 }
 
@@ -444,7 +693,17 @@ template <typename Ptr>
 template <typename Y>
 auto iosp::shared_ptr<Ptr>::owner_before(const shared_ptr<Y> &other) const noexcept -> bool
 {
-    return cb < other.cb;
+    return owner_id() < other.owner_id();
+}
+
+template <typename Ptr>
+auto iosp::shared_ptr<Ptr>::owner_id() const noexcept -> const void*
+{
+    // a lazy owner has no control block yet, the object it solely owns identifies it instead
+    control_block* c = control();
+    if(c == &lazy_owner)
+        return static_cast<const void*>(pointer);
+    return c ? c->identity() : nullptr;
 }
 
 template <typename Ptr>
@@ -474,24 +733,29 @@ auto iosp::shared_ptr<Ptr>::get() const noexcept -> Ptr*
 template <typename Ptr>
 auto iosp::shared_ptr<Ptr>::unique() const noexcept -> bool
 {
-    return cb->strong_ref == 1 ? true : false;
+    // acquire pairs with the release half of other owners' final decrement, so once we observe 1
+    // every write they made through the object is visible before we mutate it in place
+    control_block* c = control();
+    if(c == &lazy_owner)
+        return true;
+    return c ? c->strong_ref.load(std::memory_order_acquire) == 1 : false;
 }
 
 template <typename Ptr>
 auto iosp::shared_ptr<Ptr>::use_count() const noexcept -> std::size_t
 {
-    return cb ? cb->strong_ref.load() : 0;
+    control_block* c = control();
+    if(c == &lazy_owner)
+        return 1;
+    return c ? c->strong_ref.load(std::memory_order_relaxed) : 0;
 }
 
 template <typename Ptr>
 auto iosp::shared_ptr<Ptr>::reset() noexcept -> void
 {
-    if(cb) {
-        if(cb->strong_ref.fetch_sub(1) == 1) {
-            cb->destroy();
-        }
-        cb = nullptr;
-    }
+    release_ownership();
+    cb = nullptr;
+    pointer = nullptr;
 }
 
 template <typename Ptr>
@@ -499,4 +763,69 @@ auto iosp::shared_ptr<Ptr>::swap(shared_ptr &other) noexcept -> void
 {
     std::swap(pointer, other.pointer);
     std::swap(cb, other.cb);
-}
\ No newline at end of file
+}
+
+template<typename T, typename OutputIt>
+auto iosp::share_into(const iosp::shared_ptr<T>& s, size_t n, OutputIt out) -> OutputIt
+{
+    control_block* cb = s.share_control_block();
+    if(cb)
+        cb->add_ref(n);
+
+    size_t wrapped = 0;
+    try {
+        while(wrapped < n) {
+            iosp::shared_ptr<T> copy(s.pointer, cb); // owns one of the references counted above
+            wrapped++;
+            *out++ = std::move(copy); // if this throws, copy drops its own reference
+        }
+    } catch(...) {
+        if(cb && wrapped < n && cb->drop_ref(n - wrapped)) // only the references no copy ever held
+            cb->destroy();
+        throw;
+    }
+    return out;
+}
+
+template<typename T>
+auto iosp::share_n(const iosp::shared_ptr<T>& s, size_t n) -> std::vector<iosp::shared_ptr<T>>
+{
+    std::vector<iosp::shared_ptr<T>> copies;
+    copies.reserve(n);
+    iosp::share_into(s, n, std::back_inserter(copies));
+    return copies;
+}
+
+template<typename ForwardIt>
+auto iosp::release_range(ForwardIt first, ForwardIt last) -> void
+{
+    // runs of the same owner are folded while walking, so the common case never sorts
+    std::vector<std::pair<control_block*, size_t>> owners;
+    for(ForwardIt it = first; it != last; ++it) {
+        if(it->is_lazy())
+            it->release_ownership(); // sole owner, nothing to batch
+        else if(it->cb && !owners.empty() && owners.back().first == it->cb)
+            owners.back().second++;
+        else if(it->cb)
+            owners.emplace_back(it->cb, 1);
+        it->cb = nullptr;
+        it->pointer = nullptr;
+    }
+
+    if(owners.size() > 1) {
+        std::sort(owners.begin(), owners.end());
+        size_t merged = 0;
+        for(size_t i = 1; i < owners.size(); i++) {
+            if(owners[i].first == owners[merged].first)
+                owners[merged].second += owners[i].second;
+            else
+                owners[++merged] = owners[i];
+        }
+        owners.resize(merged + 1);
+    }
+
+    for(auto& [cb, count] : owners) {
+        if(cb->drop_ref(count)) // dropped every remaining reference
+            cb->destroy();
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "unique_ptr.hpp"
+
+// Generational handles: a slot_map keeps its objects packed in one vector, a handle names a slot
+// plus the generation it was issued for. Erasing bumps the slot's generation, so a handle that
+// outlived its object resolves to nullptr instead of to whatever reuses the slot. No control
+// blocks, and walking every live object is a plain loop over contiguous storage
+
+namespace iosp { // implementation of smart pointers
+    template<typename T>
+    struct handle;
+
+    template<typename T>
+    class slot_map;
+}
+
+template<typename T>
+struct iosp::handle
+{
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0; // never issued, a default handle is always stale
+
+    auto operator==(const handle& h) const noexcept -> bool { return index == h.index && generation == h.generation; }
+    auto operator!=(const handle& h) const noexcept -> bool { return !(*this == h); }
+    explicit operator bool() const noexcept { return generation != 0; }
+};
+
+template<typename T>
+class iosp::slot_map
+{
+    struct slot
+    {
+        std::uint32_t dense; // position in objects while live, next free slot otherwise
+        std::uint32_t generation;
+    };
+
+    static constexpr std::uint32_t no_slot = ~std::uint32_t(0);
+
+    std::vector<T> objects; // live objects, packed
+    std::vector<std::uint32_t> owners; // slot of objects[i]
+    std::vector<slot> slots;
+    std::uint32_t free_head = no_slot;
+
+    auto find(iosp::handle<T> h) const noexcept -> const slot*;
+    auto allocate_slot(std::uint32_t dense) -> iosp::handle<T>;
+
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    // Members
+    template<typename... Args>
+    auto emplace(Args&&... args) -> iosp::handle<T>;
+    auto insert(iosp::unique_ptr<T>&& u) -> iosp::handle<T>; // moves the object in, the heap copy is freed
+    _NODISCARD auto take(iosp::handle<T> h) -> iosp::unique_ptr<T>; // moves it back out, null if h is stale
+    auto erase(iosp::handle<T> h) -> bool;
+
+    _NODISCARD auto get(iosp::handle<T> h) noexcept -> T*; // nullptr if h is stale
+    _NODISCARD auto get(iosp::handle<T> h) const noexcept -> const T*;
+    _NODISCARD auto contains(iosp::handle<T> h) const noexcept -> bool;
+    _NODISCARD auto handle_at(std::size_t position) const noexcept -> iosp::handle<T>; // of *(begin() + position)
+
+    _NODISCARD auto size() const noexcept -> std::size_t;
+    _NODISCARD auto empty() const noexcept -> bool;
+    auto reserve(std::size_t n) -> void;
+    auto clear() noexcept -> void; // every outstanding handle goes stale
+
+    // erasing moves the last object into the hole, positions are only stable between erases
+    _NODISCARD auto begin() noexcept -> iterator { return objects.begin(); }
+    _NODISCARD auto end() noexcept -> iterator { return objects.end(); }
+    _NODISCARD auto begin() const noexcept -> const_iterator { return objects.begin(); }
+    _NODISCARD auto end() const noexcept -> const_iterator { return objects.end(); }
+};
+
+template <typename T>
+auto iosp::slot_map<T>::find(iosp::handle<T> h) const noexcept -> const slot*
+{
+    if(h.index >= slots.size() || slots[h.index].generation != h.generation)
+        return nullptr;
+    return &slots[h.index];
+}
+
+template <typename T>
+auto iosp::slot_map<T>::allocate_slot(std::uint32_t dense) -> iosp::handle<T>
+{
+    std::uint32_t index;
+    if(free_head != no_slot) {
+        index = free_head;
+        free_head = slots[index].dense;
+    } else {
+        slots.push_back(slot{0, 1});
+        index = static_cast<std::uint32_t>(slots.size() - 1);
+    }
+    slots[index].dense = dense;
+    return iosp::handle<T>{index, slots[index].generation};
+}
+
+template <typename T>
+template <typename... Args>
+auto iosp::slot_map<T>::emplace(Args&&... args) -> iosp::handle<T>
+{
+    if(owners.size() == owners.capacity()) // grown ahead so the push_back below cannot throw, geometrically like objects
+        owners.reserve(std::max<std::size_t>(8, 2 * owners.capacity()));
+    objects.emplace_back(std::forward<Args>(args)...);
+    iosp::handle<T> h;
+    try {
+        h = allocate_slot(static_cast<std::uint32_t>(objects.size() - 1));
+    } catch(...) {
+        objects.pop_back();
+        throw;
+    }
+    owners.push_back(h.index);
+    return h;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::insert(iosp::unique_ptr<T>&& u) -> iosp::handle<T>
+{
+    if(!u)
+        return iosp::handle<T>{};
+    iosp::handle<T> h = emplace(std::move(*u));
+    u.reset();
+    return h;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::take(iosp::handle<T> h) -> iosp::unique_ptr<T>
+{
+    T* p = get(h);
+    if(!p)
+        return iosp::unique_ptr<T>();
+    auto u = iosp::make_unique<T>(std::move(*p));
+    erase(h);
+    return u;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::erase(iosp::handle<T> h) -> bool
+{
+    if(!find(h))
+        return false;
+    slot& s = slots[h.index];
+    std::uint32_t hole = s.dense;
+    std::uint32_t last = static_cast<std::uint32_t>(objects.size() - 1);
+    if(hole != last) {
+        objects[hole] = std::move(objects[last]);
+        owners[hole] = owners[last];
+        slots[owners[hole]].dense = hole;
+    }
+    objects.pop_back();
+    owners.pop_back();
+
+    if(++s.generation == 0) // wrapped, skip the value default handles use
+        s.generation = 1;
+    s.dense = free_head;
+    free_head = h.index;
+    return true;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::get(iosp::handle<T> h) noexcept -> T*
+{
+    const slot* s = find(h);
+    return s ? &objects[s->dense] : nullptr;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::get(iosp::handle<T> h) const noexcept -> const T*
+{
+    const slot* s = find(h);
+    return s ? &objects[s->dense] : nullptr;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::contains(iosp::handle<T> h) const noexcept -> bool
+{
+    return find(h) != nullptr;
+}
+
+template <typename T>
+auto iosp::slot_map<T>::handle_at(std::size_t position) const noexcept -> iosp::handle<T>
+{
+    std::uint32_t index = owners[position];
+    return iosp::handle<T>{index, slots[index].generation};
+}
+
+template <typename T>
+auto iosp::slot_map<T>::size() const noexcept -> std::size_t
+{
+    return objects.size();
+}
+
+template <typename T>
+auto iosp::slot_map<T>::empty() const noexcept -> bool
+{
+    return objects.empty();
+}
+
+template <typename T>
+auto iosp::slot_map<T>::reserve(std::size_t n) -> void
+{
+    objects.reserve(n);
+    owners.reserve(n);
+    slots.reserve(n);
+}
+
+template <typename T>
+auto iosp::slot_map<T>::clear() noexcept -> void
+{
+    while(!objects.empty())
+        erase(handle_at(objects.size() - 1)); // keeps the slots, only their generations move on
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// Opt-in iterative teardown. A type that declares
+//     using deferred_teardown = void;
+// is freed through a thread-local worklist when its iosp::unique_ptr (with an empty deleter) or the
+// last iosp::shared_ptr to it lets go. The outermost release destroys its object and every release
+// that happens inside that destructor is queued instead of recursing, then the queue is drained in
+// a flat loop. A 10M node chain is freed with the stack depth of a single node
+
+namespace iosp { // implementation of smart pointers
+    template<typename T, typename = void>
+    struct has_deferred_teardown : std::false_type{};
+    template<typename T>
+    struct has_deferred_teardown<T, std::void_t<typename T::deferred_teardown>> : std::true_type{};
+    template<typename T>
+    inline constexpr bool has_deferred_teardown_v = has_deferred_teardown<std::remove_cv_t<T>>::value;
+}
+
+// Trivially destructible on purpose: releases from static destructors can run after this thread's
+// thread_local objects are gone, so nothing here may need a destructor of its own
+struct teardown_worklist
+{
+    struct step
+    {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    static constexpr std::size_t inline_capacity = 16;
+
+    step inline_steps[inline_capacity];
+    step* steps; // inline_steps until a wide structure needs more
+    std::size_t size;
+    std::size_t capacity;
+    bool draining;
+
+    static auto local() noexcept -> teardown_worklist& {
+        static thread_local teardown_worklist w{{}, nullptr, 0, 0, false};
+        return w;
+    }
+
+    auto push(step s) noexcept -> bool {
+        if(!steps) {
+            steps = inline_steps;
+            capacity = inline_capacity;
+        }
+        if(size == capacity) {
+            std::size_t grown = capacity * 2;
+            step* bigger = static_cast<step*>(std::malloc(grown * sizeof(step)));
+            if(!bigger)
+                return false;
+            std::memcpy(bigger, steps, size * sizeof(step));
+            if(steps != inline_steps)
+                std::free(steps);
+            steps = bigger;
+            capacity = grown;
+        }
+        steps[size++] = s;
+        return true;
+    }
+
+    // Destroys object now when called outermost, otherwise queues it for the outermost call's loop
+    static auto run(void (*destroy)(void*), void* object) noexcept -> void {
+        teardown_worklist& w = local();
+        if(w.draining) {
+            if(!w.push(step{destroy, object}))
+                destroy(object); // no memory for the queue, recurse this once
+            return;
+        }
+        w.draining = true;
+        destroy(object);
+        while(w.size > 0) {
+            step s = w.steps[--w.size];
+            s.destroy(s.object);
+        }
+        if(w.steps != w.inline_steps)
+            std::free(w.steps);
+        w.steps = nullptr;
+        w.capacity = 0;
+        w.draining = false;
+    }
+};
@@ -0,0 +1,143 @@
+#include "../../unique_ptr.hpp"
+#include "../../channel.hpp"
+#include <atomic>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct Job
+{
+    int id;
+    explicit Job(int i) : id(i) {}
+};
+
+std::atomic_int freed{0};
+
+struct CountingDelete
+{
+    int tag = 0; // stateful, travels through the ring with its pointer
+    auto operator()(Job* j) const noexcept -> void {
+        freed.fetch_add(tag, std::memory_order_relaxed);
+        delete j;
+    }
+};
+
+// Output iterator whose second assignment throws
+struct failing_sink {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    std::vector<iosp::unique_ptr<Job, CountingDelete>>* kept;
+    auto operator*() -> failing_sink& { return *this; }
+    auto operator++(int) -> failing_sink { return *this; }
+    auto operator=(iosp::unique_ptr<Job, CountingDelete>&& u) -> failing_sink& {
+        if(kept->size() == 1)
+            throw std::runtime_error("sink full");
+        kept->push_back(std::move(u));
+        return *this;
+    }
+};
+
+int main()
+{
+    std::cout << std::boolalpha;
+    iosp::channel<Job> ch(3);
+    std::cout << "capacity: " << ch.capacity() << "\n"; // 4
+
+    iosp::unique_ptr<Job> a = iosp::make_unique<Job>(1);
+    Job* raw = a.get();
+    std::cout << "pushed: " << ch.try_push(a) << " released: " << !a << "\n"; // pushed: true released: true
+    iosp::unique_ptr<Job> out;
+    std::cout << "popped same object: " << (ch.try_pop(out) && out.get() == raw) << "\n"; // true
+    std::cout << "empty pop: " << ch.try_pop(out) << "\n"; // false
+
+    std::cout << "\n---- batches ----\n";
+    std::vector<iosp::unique_ptr<Job>> batch;
+    for(int i = 0; i < 6; i++)
+        batch.push_back(iosp::make_unique<Job>(i));
+    auto rest = ch.try_push_n(batch.begin(), batch.end()); // only 4 fit
+    std::cout << "sent " << (rest - batch.begin()) << ", first kept " << (*rest)->id << "\n"; // sent 4, first kept 4
+    iosp::unique_ptr<Job> extra = iosp::make_unique<Job>(9);
+    std::cout << "push when full: " << ch.try_push(extra) << " still owned: " << bool(extra) << "\n"; // push when full: false still owned: true
+    std::vector<iosp::unique_ptr<Job>> received;
+    std::cout << "received " << ch.try_pop_n(std::back_inserter(received), 10) << ": "; // received 4: 0 1 2 3
+    for(auto& j : received)
+        std::cout << j->id << " ";
+    std::cout << "\n";
+
+    std::cout << "\n---- stateful deleters and leftovers ----\n";
+    {
+        iosp::channel<Job, CountingDelete> owned(8);
+        for(int i = 1; i <= 3; i++) {
+            iosp::unique_ptr<Job, CountingDelete> j(new Job(i), CountingDelete{i * 10});
+            (void)owned.try_push(j);
+        }
+        iosp::unique_ptr<Job, CountingDelete> first;
+        (void)owned.try_pop(first);
+    } // first freed with tag 10, the two left in the ring with 20 and 30
+    std::cout << "deleters ran with their tags: " << freed.load() << "\n"; // 60
+
+    std::cout << "\n---- batch pop into a throwing output ----\n";
+    {
+        freed = 0;
+        iosp::channel<Job, CountingDelete> ring(4);
+        for(int i = 0; i < 4; i++) {
+            iosp::unique_ptr<Job, CountingDelete> j(new Job(i), CountingDelete{1});
+            (void)ring.try_push(j);
+        }
+        std::vector<iosp::unique_ptr<Job, CountingDelete>> kept;
+        try {
+            ring.try_pop_n(failing_sink{&kept}, 4);
+        } catch(const std::runtime_error&) {
+            std::cout << "kept: " << kept.size() << " destroyed: " << freed.load() << "\n"; // kept: 1 destroyed: 3
+        }
+        iosp::unique_ptr<Job, CountingDelete> left;
+        std::cout << "claimed cells handed back, pop finds: " << ring.try_pop(left) << "\n"; // false
+        int refilled = 0;
+        for(int i = 0; i < 4; i++) {
+            iosp::unique_ptr<Job, CountingDelete> j(new Job(i), CountingDelete{0});
+            refilled += ring.try_push(j);
+        }
+        std::cout << "refilled: " << refilled << "\n"; // 4
+    }
+
+    std::cout << "\n---- producers and consumers ----\n";
+    constexpr int producers = 3, consumers = 3, per_producer = 20000;
+    iosp::channel<Job> work(64);
+    std::atomic_long sum{0};
+    std::atomic_int count{0};
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for(int i = 0; i < per_producer; i++) {
+                auto j = iosp::make_unique<Job>(p * per_producer + i);
+                work.push(j);
+            }
+        });
+    }
+    std::vector<std::thread> readers;
+    for(int c = 0; c < consumers; c++) {
+        readers.emplace_back([&] {
+            iosp::unique_ptr<Job> j;
+            while(work.pop(j)) {
+                sum.fetch_add(j->id, std::memory_order_relaxed);
+                count.fetch_add(1, std::memory_order_relaxed);
+                j.reset();
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    work.close();
+    for(auto& t : readers)
+        t.join();
+    long n = long(producers) * per_producer;
+    std::cout << "delivered all: " << (count.load() == n && sum.load() == n * (n - 1) / 2) << "\n"; // true
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../cow_ptr.hpp"
+#include <iostream>
+#include <string>
+
+int main()
+{
+    iosp::cow_ptr<std::string> a = iosp::make_cow<std::string>("hello");
+    iosp::cow_ptr<std::string> b = a; // shares the same string
+
+    std::cout << "a.use_count(): " << a.use_count() << "\n"; // 2
+    std::cout << "same object: " << std::boolalpha << (a.get() == b.get()) << "\n"; // true
+
+    std::cout << "\n---- write through b ----\n";
+    b.write() += " world"; // b detaches, a keeps the original
+
+    std::cout << "a: " << *a << " use_count " << a.use_count() << "\n"; // hello 1
+    std::cout << "b: " << *b << " use_count " << b.use_count() << "\n"; // hello world 1
+    std::cout << "same object: " << (a.get() == b.get()) << "\n"; // false
+
+    std::cout << "\n---- write through unique a ----\n";
+    const std::string* before = a.get();
+    a.write() += "!"; // no copy, a is the only owner
+    std::cout << "a: " << *a << " copied: " << (a.get() != before) << "\n"; // hello! false
+
+    iosp::cow_ptr<std::string> empty;
+    std::cout << "empty.unique(): " << empty.unique() << "\n"; // false, no control block
+
+    return 0;
+}
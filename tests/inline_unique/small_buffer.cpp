@@ -0,0 +1,78 @@
+#include "../../unique_ptr.hpp"
+#include "../../inline_unique.hpp"
+#include <iostream>
+#include <vector>
+
+struct Shape
+{
+    virtual ~Shape() = default;
+    virtual auto area() const -> double = 0;
+};
+
+struct Square : Shape
+{
+    double side;
+    explicit Square(double s) : side(s) {}
+    auto area() const -> double override { return side * side; }
+};
+
+struct Tag
+{
+    virtual ~Tag() = default;
+    char tag[8] = "tagged";
+};
+
+struct Label : Tag, Shape // Shape is not at offset 0, relocation has to adjust the pointer
+{
+    int length;
+    explicit Label(int n) : length(n) {}
+    auto area() const -> double override { return length; }
+};
+
+struct Mesh : Shape
+{
+    double vertices[64] = {};
+    auto area() const -> double override { return 99; }
+};
+
+int main()
+{
+    std::cout << std::boolalpha;
+    auto sq = iosp::make_inline_unique<Shape, Square>(3.0);
+    auto mesh = iosp::make_inline_unique<Shape, Mesh>();
+    std::cout << "square inline: " << sq.is_inline() << " area " << sq->area() << "\n"; // square inline: true area 9
+    std::cout << "mesh inline: " << mesh.is_inline() << " area " << mesh->area() << "\n"; // mesh inline: false area 99
+
+    auto label = iosp::make_inline_unique<Shape, Label>(7);
+    iosp::inline_unique<Shape> moved = std::move(label); // relocated into the new buffer
+    std::cout << "moved label: " << moved->area() << " source empty: " << !label << " inline: " << moved.is_inline() << "\n"; // moved label: 7 source empty: true inline: true
+    auto at = reinterpret_cast<char*>(moved.get()) - reinterpret_cast<char*>(&moved);
+    std::cout << "Shape part inside the buffer, past offset 0: " << (at > 0 && at < 48) << "\n"; // true
+
+    Shape* heap = mesh.get();
+    iosp::inline_unique<Shape> stolen = std::move(mesh); // heap objects just hand the pointer over
+    std::cout << "heap pointer kept: " << (stolen.get() == heap) << "\n"; // true
+
+    std::cout << "\n---- containers and swaps ----\n";
+    std::vector<iosp::inline_unique<Shape>> shapes;
+    for(int i = 1; i <= 20; i++) { // growth relocates every element
+        if(i % 2)
+            shapes.push_back(iosp::make_inline_unique<Shape, Square>(double(i)));
+        else
+            shapes.push_back(iosp::make_inline_unique<Shape, Label>(i));
+    }
+    double total = 0;
+    for(auto& s : shapes)
+        total += s->area();
+    std::cout << "total area: " << total << "\n"; // 1440
+    shapes[0].swap(shapes[1]);
+    std::cout << "after swap: " << shapes[0]->area() << " " << shapes[1]->area() << "\n"; // after swap: 2 1
+
+    iosp::inline_unique<Shape> adopted(iosp::make_unique<Square>(2.0));
+    std::cout << "adopted from unique_ptr: " << adopted->area() << " inline: " << adopted.is_inline() << "\n"; // adopted from unique_ptr: 4 inline: false
+    adopted.reset();
+    std::cout << "reset: " << !adopted << "\n"; // true
+    std::cout << "sizeof: " << sizeof(iosp::inline_unique<Shape>) << "\n"; // 64
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../intern.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    auto a = iosp::make_interned<std::string>("routing-table");
+    auto b = iosp::make_interned<std::string>(std::string("routing-") + "table");
+    auto c = iosp::make_interned<std::string>("feature-flags");
+
+    std::cout << std::boolalpha;
+    std::cout << "equal values share: " << (a.get() == b.get()) << " use_count " << a.use_count() << "\n"; // true 2
+    std::cout << "different values: " << (a.get() != c.get()) << "\n"; // true
+
+    auto& table = iosp::intern_table<std::string>::instance();
+    auto st = table.stats();
+    std::cout << "live " << st.live_values << " requests " << st.requests << " hits " << st.hits
+              << " saved " << (st.bytes_saved > 0) << "\n"; // live 2 requests 3 hits 1 saved true
+
+    c.reset(); // last reference, the entry goes with it
+    std::cout << "live after dropping c: " << table.stats().live_values << "\n"; // 1
+
+    auto c2 = iosp::make_interned<std::string>("feature-flags"); // interned afresh
+    std::cout << "reinterned use_count: " << c2.use_count() << "\n"; // 1
+
+    std::cout << "\n---- concurrent interning ----\n";
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for(int i = 0; i < 20000; i++) {
+                auto v = iosp::make_interned<std::string>("key-" + std::to_string(i % 50));
+                auto w = iosp::make_interned<std::string>("key-" + std::to_string(i % 50));
+                if(v.get() != w.get())
+                    std::cout << "not deduplicated\n";
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    std::cout << "live after threads: " << table.stats().live_values << "\n"; // 2, a/b and c2
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "../../unique_ptr.hpp"
+#include "../../interprocess_ptr.hpp"
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Dataset {
+    int values[1024];
+    iosp::offset_ptr<int> last; // stays valid wherever the segment is mapped
+
+    Dataset() {
+        for(int i = 0; i < 1024; i++)
+            values[i] = i * 3;
+        last = &values[1023];
+    }
+};
+
+constexpr int children = 4;
+
+int main()
+{
+    const std::string name = "/iosp_test_" + std::to_string(::getpid());
+    iosp::shm_segment segment = iosp::shm_segment::create(name, 1 << 20);
+
+    auto data = iosp::make_interprocess_shared<Dataset>(segment);
+    std::cout << "in use after make: " << (segment.bytes_in_use() > 0) << "\n"; // 1
+
+    for(int c = 0; c < children; c++) {
+        std::uint64_t handoff = data.share_with_process(); // the child owns this reference
+        if(::fork() == 0) {
+            // a fresh mapping of the same segment, at a different address than the parent's
+            iosp::shm_segment view = iosp::shm_segment::open(name);
+            auto mine = iosp::interprocess_shared_ptr<Dataset>::adopt(view, handoff);
+            bool ok = mine.get() != data.get() && mine->values[10] == 30 && *mine->last == 1023 * 3;
+            mine.reset();
+            ::_exit(ok ? 0 : 1);
+        }
+    }
+
+    data.reset(); // children may outlive the parent's reference, the last one frees it
+
+    int failed = 0;
+    for(int c = 0; c < children; c++) {
+        int status = 0;
+        ::wait(&status);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed++;
+    }
+
+    std::cout << "failed children: " << failed << "\n"; // 0
+    std::cout << "bytes in use after all released: " << segment.bytes_in_use() << "\n"; // 0
+
+    bool ok = failed == 0 && segment.bytes_in_use() == 0;
+    segment.unlink();
+    return ok ? 0 : 1;
+}
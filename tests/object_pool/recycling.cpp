@@ -0,0 +1,73 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../object_pool.hpp"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+struct Parser
+{
+    std::vector<char> buffer;
+    int parsed = 0;
+    Parser() : buffer(4096) {}
+};
+
+int main()
+{
+    iosp::object_pool<Parser> pool(8, [] { return new Parser(); }, [](Parser& p) { p.parsed = 0; });
+
+    Parser* first;
+    {
+        auto p = pool.acquire();
+        p->parsed = 42;
+        first = p.get();
+    } // back to the free list, not destroyed
+
+    auto again = pool.acquire();
+    std::cout << std::boolalpha;
+    std::cout << "same object: " << (again.get() == first) << "\n"; // true
+    std::cout << "reset hook ran: " << (again->parsed == 0) << "\n"; // true
+    std::cout << "buffer kept: " << again->buffer.size() << "\n"; // 4096
+    again = nullptr;
+
+    std::cout << "\n---- shared handles ----\n";
+    {
+        auto s = pool.acquire_shared();
+        auto t = s;
+        std::cout << "use_count " << t.use_count() << " recycled object: " << (s.get() == first) << "\n"; // use_count 2 recycled object: true
+    }
+    std::cout << "cached after last shared owner: " << pool.cached() << "\n"; // 1
+
+    std::cout << "\n---- high water trimming ----\n";
+    {
+        std::vector<iosp::object_pool<Parser>::unique_handle> burst;
+        for(int i = 0; i < 12; i++)
+            burst.push_back(pool.acquire());
+    }
+    std::cout << "cached after burst: " << pool.cached() << "\n"; // 8, the rest went over max_cached
+    std::cout << "first trim: " << pool.trim() << "\n"; // 0, the burst needed all of them
+    auto one = pool.acquire();
+    one = nullptr;
+    std::cout << "second trim: " << pool.trim() << " cached " << pool.cached() << "\n"; // second trim: 7 cached 1
+    std::cout << "constructed " << pool.constructed_count() << " reused " << pool.reused_count() << "\n"; // constructed 12 reused 4
+
+    std::cout << "\n---- reset hook using other pools ----\n";
+    std::vector<iosp::unique_ptr<iosp::object_pool<Parser>>> side_pools;
+    iosp::object_pool<Parser> nested(8, [] { return new Parser(); }, [&](Parser& p) {
+        p.parsed = 0;
+        for(int i = 0; i < 8; i++) { // each new pool adds an entry to this thread's cache
+            side_pools.push_back(iosp::make_unique<iosp::object_pool<Parser>>());
+            side_pools.back()->acquire().reset();
+        }
+    });
+    nested.acquire().reset();
+    std::cout << "recycled after the hook: " << nested.cached() << "\n"; // 1
+    side_pools.clear();
+
+    std::cout << "\n---- released on another thread ----\n";
+    auto handle = pool.acquire_shared();
+    std::thread([h = std::move(handle)]() mutable { h.reset(); }).join(); // lands in that thread's cache, freed at its exit
+    std::cout << "cached here: " << pool.cached() << "\n"; // 0
+
+    return 0;
+}
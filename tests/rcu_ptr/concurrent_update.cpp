@@ -0,0 +1,51 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../rcu_ptr.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static std::atomic_int live{0};
+
+struct Table {
+    int version;
+    int check;
+    Table(int v, int c) : version(v), check(c) { live++; }
+    ~Table() { version = check = -1; live--; }
+};
+
+int main()
+{
+    iosp::rcu_ptr<Table> table(iosp::make_shared<Table>(0, 0));
+    std::atomic_bool stop{false};
+    std::atomic_int torn{0};
+
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while(!stop.load()) {
+                iosp::rcu_read_guard guard;
+                const Table* t = table.read(guard);
+                iosp::rcu_read_guard nested; // nesting keeps the outer epoch
+                if(t->version != t->check || t->version < 0)
+                    torn++;
+            }
+        });
+    }
+
+    for(int v = 1; v <= 2000; v++)
+        table.update(iosp::make_shared<Table>(v, v));
+
+    stop = true;
+    for(auto& t : readers)
+        t.join();
+
+    table.synchronize();
+    std::cout << "torn reads: " << torn.load() << "\n"; // 0
+    std::cout << "retired after synchronize: " << table.retired_count() << "\n"; // 0
+    std::cout << "live tables: " << live.load() << "\n"; // 1, only the published one
+    std::cout << "current version: " << table.load()->version << "\n"; // 2000
+
+    return torn.load() == 0 && live.load() == 1 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../serialization.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Leaf {
+    std::string name;
+    std::vector<double> weights;
+
+    template<typename Archive>
+    void serialize(Archive& ar) { ar(name, weights); }
+};
+
+struct Node {
+    int id = 0;
+    std::vector<iosp::shared_ptr<Node>> children;
+    iosp::shared_ptr<const Leaf> leaf;
+    iosp::unique_ptr<int> scratch;
+
+    template<typename Archive>
+    void serialize(Archive& ar) { ar(id, children, leaf, scratch); }
+};
+
+int main()
+{
+    // diamond: root -> a, b; a -> shared; b -> shared. Every node points at the same leaf
+    auto leaf = iosp::make_shared<Leaf>(Leaf{"weights", {0.5, 1.5, 2.5}});
+    auto shared = iosp::make_shared<Node>();
+    shared->id = 3;
+    shared->leaf = leaf;
+    shared->scratch = iosp::make_unique<int>(99);
+    auto a = iosp::make_shared<Node>();
+    a->id = 1;
+    a->children.push_back(shared);
+    a->leaf = leaf;
+    auto b = iosp::make_shared<Node>();
+    b->id = 2;
+    b->children.push_back(shared);
+    b->leaf = leaf;
+    auto root = iosp::make_shared<Node>();
+    root->children = {a, b};
+
+    std::stringstream buffer;
+    iosp::archive_writer writer(buffer);
+    writer(root);
+    std::cout << "objects written: " << writer.shared_objects() << "\n"; // 5, 4 nodes + 1 leaf
+    std::cout << "back references: " << writer.shared_references() << "\n"; // 3, shared once, leaf twice
+
+    iosp::shared_ptr<Node> loaded;
+    {
+        iosp::archive_reader reader(buffer);
+        reader(loaded);
+        std::cout << "objects loaded: " << reader.shared_objects() << "\n"; // 5
+    }
+
+    auto& la = loaded->children[0];
+    auto& lb = loaded->children[1];
+    std::cout << std::boolalpha;
+    std::cout << "ids: " << la->id << " " << lb->id << " " << la->children[0]->id << "\n"; // 1 2 3
+    std::cout << "diamond shared: " << (la->children[0].get() == lb->children[0].get()) << "\n"; // true
+    std::cout << "leaf shared: " << (la->leaf.get() == lb->leaf.get() && la->leaf.get() == la->children[0]->leaf.get()) << "\n"; // true
+    std::cout << "shared use_count: " << la->children[0].use_count() << "\n"; // 2
+    std::cout << "leaf: " << la->leaf->name << " " << la->leaf->weights[2] << "\n"; // weights 2.5
+    std::cout << "scratch: " << *la->children[0]->scratch << " null elsewhere: " << !la->scratch << "\n"; // 99 true
+
+    std::cout << "\n---- streaming temporaries ----\n";
+    std::stringstream stream;
+    {
+        iosp::archive_writer w(stream);
+        for(int i = 1; i <= 3; i++) {
+            auto p = iosp::make_shared<Node>(); // freed right after, the next one may get its address
+            p->id = i;
+            w(p);
+        }
+        std::cout << "streamed objects: " << w.shared_objects() << " back references: " << w.shared_references() << "\n"; // 3 0
+    }
+    {
+        iosp::archive_reader r(stream);
+        iosp::shared_ptr<Node> p1, p2, p3;
+        r(p1, p2, p3);
+        std::cout << "streamed ids: " << p1->id << " " << p2->id << " " << p3->id << "\n"; // 1 2 3
+    }
+
+    std::cout << "\n---- alias of the first member ----\n";
+    std::stringstream aliased;
+    {
+        auto n = iosp::make_shared<Node>();
+        n->id = 7;
+        iosp::shared_ptr<int> idp(n, &n->id); // same owner and same address as n
+        iosp::archive_writer w(aliased);
+        w(n, idp);
+        std::cout << "written: " << w.shared_objects() << " back references: " << w.shared_references() << "\n"; // 2 0
+    }
+    {
+        iosp::archive_reader r(aliased);
+        iosp::shared_ptr<Node> n;
+        iosp::shared_ptr<int> idp;
+        r(n, idp);
+        std::cout << "loaded: " << n->id << " " << *idp << "\n"; // 7 7
+    }
+
+    std::stringstream garbage("not a snapshot");
+    try {
+        iosp::archive_reader bad(garbage);
+    } catch(const std::runtime_error& e) {
+        std::cout << "rejected: " << e.what() << "\n";
+    }
+
+    return 0;
+}
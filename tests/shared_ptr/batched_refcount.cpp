@@ -0,0 +1,75 @@
+#include "../../unique_ptr.hpp"
+#include <memory>
+#include "../../shared_ptr.hpp"
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+struct Message {
+    int id;
+    explicit Message(int i) : id(i) {}
+    ~Message() { std::cout << "Message " << id << " destroyed\n"; }
+};
+
+// Output iterator whose second assignment throws
+struct failing_sink {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    std::vector<iosp::shared_ptr<Message>>* kept;
+    auto operator*() -> failing_sink& { return *this; }
+    auto operator++(int) -> failing_sink { return *this; }
+    auto operator=(iosp::shared_ptr<Message>&& s) -> failing_sink& {
+        if(kept->size() == 1)
+            throw std::runtime_error("sink full");
+        kept->push_back(std::move(s));
+        return *this;
+    }
+};
+
+int main()
+{
+    auto msg = iosp::make_shared<Message>(1);
+
+    auto subscribers = iosp::share_n(msg, 64); // one fetch_add of 64
+    std::cout << "copies: " << subscribers.size() << " use_count: " << msg.use_count() << "\n"; // 64 65
+    std::cout << "same object: " << std::boolalpha << (subscribers[63].get() == msg.get()) << "\n"; // true
+
+    iosp::shared_ptr<Message> slots[4];
+    iosp::share_into(msg, 4, slots);
+    std::cout << "after share_into: " << msg.use_count() << "\n"; // 69
+
+    auto other = iosp::make_shared<Message>(2);
+    std::vector<iosp::shared_ptr<Message>> mixed(subscribers.begin(), subscribers.begin() + 3);
+    mixed.push_back(other);
+    mixed.push_back(nullptr);
+    other.reset(); // mixed now holds the last reference to message 2
+
+    iosp::release_range(subscribers.begin(), subscribers.end()); // one fetch_sub of 64
+    std::cout << "after releasing subscribers: " << msg.use_count() << "\n"; // 8
+
+    std::cout << "\n---- release mixed range ----\n";
+    iosp::release_range(mixed.begin(), mixed.end()); // message 2 destroyed, message 1 drops by 3
+    std::cout << "msg use_count: " << msg.use_count() << " mixed[0] empty: " << !mixed[0] << "\n"; // 5 true
+
+    iosp::shared_ptr<int> lazy(new int(3), iosp::lazy);
+    auto lazy_copies = iosp::share_n(lazy, 2);
+    std::cout << "lazy shared: " << lazy.use_count() << "\n"; // 3
+
+    std::cout << "\n---- share_into with a throwing output ----\n";
+    std::vector<iosp::shared_ptr<Message>> kept;
+    try {
+        iosp::share_into(msg, 8, failing_sink{&kept});
+    } catch(const std::runtime_error&) {
+        std::cout << "kept: " << kept.size() << " msg use_count: " << msg.use_count() << "\n"; // 1 6
+    }
+    kept.clear();
+    std::cout << "after dropping kept: " << msg.use_count() << "\n"; // 5
+
+    std::cout << "\n---- end of scope ----\n";
+    return 0;
+}
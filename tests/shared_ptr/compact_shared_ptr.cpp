@@ -0,0 +1,43 @@
+#include "../../unique_ptr.hpp"
+#include <memory>
+#include "../../shared_ptr.hpp"
+#include "../../compact_shared_ptr.hpp"
+#include <iostream>
+#include <stdexcept>
+
+struct Point {
+    double x, y;
+    Point(double a, double b) : x(a), y(b) {}
+};
+
+int main()
+{
+    std::cout << "sizeof compact: " << sizeof(iosp::compact_shared_ptr<Point>) << " shared: "
+              << sizeof(iosp::shared_ptr<Point>) << "\n"; // 8 16
+
+    auto c = iosp::make_compact_shared<Point>(1.0, 2.0);
+    auto c2 = c;
+    std::cout << "use_count: " << c.use_count() << " y: " << c2->y << "\n"; // 2 2
+
+    iosp::shared_ptr<Point> s = c; // to shared_ptr
+    std::cout << "shared use_count: " << s.use_count() << " same object: " << std::boolalpha << (s.get() == c.get()) << "\n"; // 3 true
+
+    iosp::compact_shared_ptr<Point> back(iosp::make_shared<Point>(3.0, 4.0)); // from a make_shared result
+    std::cout << "back x: " << back->x << " use_count: " << back.use_count() << "\n"; // 3 1
+
+    try {
+        iosp::compact_shared_ptr<Point> bad(iosp::shared_ptr<Point>(new Point(0, 0))); // separate allocation
+    } catch(const std::invalid_argument&) {
+        std::cout << "rejected raw pointer owner\n";
+    }
+
+    auto pair = iosp::make_shared<Point>(5.0, 6.0);
+    iosp::shared_ptr<Point> alias(pair, pair.get());
+    iosp::compact_shared_ptr<Point> from_alias(alias); // aliasing the owner's own object is fine
+    std::cout << "alias to own object: " << from_alias->y << "\n"; // 6
+
+    c.reset();
+    c2.reset();
+    std::cout << "after compact resets: " << s.use_count() << "\n"; // 1
+    return 0;
+}
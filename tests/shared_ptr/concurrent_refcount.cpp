@@ -0,0 +1,131 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Stress and litmus checks for the reference count orderings, meant to be run under ThreadSanitizer
+// as well (-fsanitize=thread). Every thread writes plain, non-atomic fields of the shared object
+// before dropping its reference; the destructor reads all of them. If the final release did not
+// acquire the other owners' writes, TSan reports the race and the sums come out wrong
+
+constexpr int threads = 4;
+
+std::atomic_int destroyed{0};
+std::atomic_long seen{0};
+
+struct Tracked
+{
+    long slots[threads] = {};
+    int member = 0;
+    ~Tracked() {
+        long sum = 0;
+        for(long s : slots)
+            sum += s;
+        seen.fetch_add(sum, std::memory_order_relaxed);
+        destroyed.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+template<typename Body>
+auto race(Body body) -> void
+{
+    std::atomic_int ready{0};
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while(ready.load() < threads) // start together to widen the window
+                std::this_thread::yield();
+            body(t);
+        });
+    }
+    for(auto& w : workers)
+        w.join();
+}
+
+auto expect(const char* name, int objects, long sum) -> void
+{
+    int d = destroyed.exchange(0);
+    long s = seen.exchange(0);
+    std::cout << name << ((d == objects && s == sum) ? "ok" : "FAILED") << "\n";
+}
+
+int main()
+{
+    constexpr int rounds = 1000;
+
+    // copies made and dropped by every thread, the last one out destroys
+    for(int r = 0; r < rounds; r++) {
+        std::vector<iosp::shared_ptr<Tracked>> copies(threads, iosp::make_shared<Tracked>());
+        race([&](int t) {
+            iosp::shared_ptr<Tracked> local = copies[t];
+            copies[t]->slots[t] = 1;
+            copies[t].reset();
+            iosp::shared_ptr<Tracked> again(local);
+        });
+    }
+    expect("copy and reset against final release: ", rounds, long(rounds) * threads); // ok
+
+    // moves and copy assignments, the object hops between threads' locals
+    for(int r = 0; r < rounds; r++) {
+        iosp::shared_ptr<Tracked> source = iosp::make_shared<Tracked>();
+        std::vector<iosp::shared_ptr<Tracked>> copies(threads, source);
+        source.reset();
+        race([&](int t) {
+            iosp::shared_ptr<Tracked> a = std::move(copies[t]);
+            iosp::shared_ptr<Tracked> b;
+            b = a;
+            a = std::move(b);
+            a->slots[t] = 2;
+            iosp::shared_ptr<Tracked> c;
+            c = std::move(a);
+        });
+    }
+    expect("move and assignment: ", rounds, 2L * rounds * threads); // ok
+
+    // aliasing pointers into a member keep the whole object alive
+    for(int r = 0; r < rounds; r++) {
+        auto owner = iosp::make_shared<Tracked>();
+        std::vector<iosp::shared_ptr<int>> members(threads, iosp::shared_ptr<int>(owner, &owner->member));
+        std::vector<iosp::shared_ptr<Tracked>> owners(threads, owner);
+        owner.reset();
+        race([&](int t) {
+            owners[t]->slots[t] = 3;
+            owners[t].reset(); // the aliases may now hold the last references
+            iosp::shared_ptr<int> alias = members[t];
+            members[t].reset();
+        });
+    }
+    expect("aliasing: ", rounds, 3L * rounds * threads); // ok
+
+    // message passing: only one thread writes, any of them may end up destroying
+    for(int r = 0; r < rounds; r++) {
+        auto writer_copy = iosp::make_shared<Tracked>();
+        std::vector<iosp::shared_ptr<Tracked>> copies(threads, writer_copy);
+        writer_copy.reset();
+        race([&](int t) {
+            if(t == 0)
+                copies[t]->slots[0] = 4;
+            copies[t] = nullptr;
+        });
+    }
+    expect("litmus, write then release: ", rounds, 4L * rounds); // ok
+
+    // batched paths count through the same helpers
+    for(int r = 0; r < rounds / 10; r++) {
+        auto base = iosp::make_shared<Tracked>();
+        std::vector<std::vector<iosp::shared_ptr<Tracked>>> batches;
+        for(int t = 0; t < threads; t++)
+            batches.push_back(iosp::share_n(base, 8));
+        base.reset();
+        race([&](int t) {
+            batches[t][0]->slots[t] = 5;
+            iosp::release_range(batches[t].begin(), batches[t].end());
+        });
+    }
+    expect("share_n and release_range: ", rounds / 10, 5L * (rounds / 10) * threads); // ok
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include <iostream>
+
+// Chains far deeper than the stack could unwind recursively, especially under AddressSanitizer
+
+int destroyed = 0;
+
+struct ListNode
+{
+    using deferred_teardown = void; // opt in
+    iosp::unique_ptr<ListNode> next;
+    ~ListNode() { destroyed++; }
+};
+
+struct SharedNode
+{
+    using deferred_teardown = void;
+    iosp::shared_ptr<SharedNode> next;
+    ~SharedNode() { destroyed++; }
+};
+
+struct TreeNode
+{
+    using deferred_teardown = void;
+    iosp::unique_ptr<TreeNode> left, right;
+    ~TreeNode() { destroyed++; }
+};
+
+auto build_tree(int depth) -> iosp::unique_ptr<TreeNode>
+{
+    auto n = iosp::make_unique<TreeNode>();
+    if(depth > 0) {
+        n->left = build_tree(depth - 1);
+        n->right = build_tree(depth - 1);
+    }
+    return n;
+}
+
+int main()
+{
+    constexpr int length = 1000000;
+
+    auto head = iosp::make_unique<ListNode>();
+    ListNode* tail = head.get();
+    for(int i = 1; i < length; i++) {
+        tail->next = iosp::make_unique<ListNode>();
+        tail = tail->next.get();
+    }
+    head.reset();
+    std::cout << "unique_ptr chain freed: " << destroyed << "\n"; // 1000000
+
+    destroyed = 0;
+    iosp::shared_ptr<SharedNode> first = iosp::make_shared<SharedNode>();
+    SharedNode* last = first.get();
+    for(int i = 1; i < length; i++) {
+        last->next = iosp::make_shared<SharedNode>();
+        last = last->next.get();
+    }
+    first = nullptr;
+    std::cout << "shared_ptr chain freed: " << destroyed << "\n"; // 1000000
+
+    destroyed = 0;
+    iosp::shared_ptr<SharedNode> lazy_head(new SharedNode, iosp::lazy); // never shared, the owner deletes it directly
+    SharedNode* lazy_tail = lazy_head.get();
+    for(int i = 1; i < length; i++) {
+        lazy_tail->next = iosp::shared_ptr<SharedNode>(new SharedNode, iosp::lazy);
+        lazy_tail = lazy_tail->next.get();
+    }
+    lazy_head.reset();
+    std::cout << "lazy shared_ptr chain freed: " << destroyed << "\n"; // 1000000
+
+    destroyed = 0;
+    iosp::shared_ptr<SharedNode> a = iosp::make_shared<SharedNode>();
+    a->next = iosp::make_shared<SharedNode>();
+    iosp::shared_ptr<SharedNode> b = a->next; // shared tail outlives the head
+    a.reset();
+    std::cout << "head only: " << destroyed << " tail alive: " << b.use_count() << "\n"; // head only: 1 tail alive: 1
+    b.reset();
+
+    destroyed = 0;
+    iosp::shared_ptr<SharedNode> queue = iosp::make_shared<SharedNode>();
+    queue->next = iosp::make_shared<SharedNode>();
+    queue->next->next = iosp::make_shared<SharedNode>();
+    queue = queue->next; // the source lives inside the node being released
+    queue = std::move(queue->next);
+    std::cout << "popped front: " << destroyed << " left: " << (queue && !queue->next) << "\n"; // popped front: 2 left: 1
+    queue.reset();
+
+    destroyed = 0;
+    build_tree(17).reset(); // wide rather than deep, the worklist grows past its inline steps
+    std::cout << "tree freed: " << destroyed << "\n"; // 262143
+
+    return 0;
+}
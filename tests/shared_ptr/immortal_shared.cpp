@@ -0,0 +1,35 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include <iostream>
+#include <string>
+
+struct Config
+{
+    std::string name;
+    explicit Config(std::string n) : name(std::move(n)) {}
+    ~Config() { std::cout << "~Config " << name << "\n"; }
+};
+
+iosp::shared_ptr<Config> defaults = iosp::make_immortal_shared<Config>("defaults"); // never destroyed
+
+int main()
+{
+    std::cout << std::boolalpha;
+    size_t before = defaults.use_count();
+    {
+        iosp::shared_ptr<Config> a = defaults;
+        iosp::shared_ptr<Config> b;
+        b = a;
+        iosp::shared_ptr<Config> c(defaults, defaults.get()); // aliasing copies skip the count too
+        std::cout << b->name << " count untouched: " << (defaults.use_count() == before) << "\n"; // defaults count untouched: true
+    }
+    std::cout << "immortal: " << (defaults.use_count() >= control_block::immortal_ref) << " unique: " << defaults.unique() << "\n"; // immortal: true unique: false
+
+    auto shared = iosp::share_n(defaults, 3); // batched paths still add and subtract, the top bit survives
+    iosp::release_range(shared.begin(), shared.end());
+    std::cout << "after batch: " << (defaults.use_count() == before) << "\n"; // true
+
+    iosp::shared_ptr<Config> mortal = iosp::make_shared<Config>("mortal");
+    mortal.reset(); // ~Config mortal
+    return 0; // no ~Config defaults, not even when the global is destroyed
+}
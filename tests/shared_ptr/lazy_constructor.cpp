@@ -0,0 +1,76 @@
+#include "../../unique_ptr.hpp"
+#include <memory>
+#include "../../shared_ptr.hpp"
+#include <iostream>
+#include <thread>
+#include <type_traits>
+
+struct Base {
+    virtual ~Base() { std::cout << "Base destroyed\n"; }
+};
+
+struct Counted {
+    static inline int destroyed = 0;
+    ~Counted() { destroyed++; }
+};
+
+struct Derived : Base {
+    int value = 7;
+    ~Derived() override { std::cout << "Derived destroyed\n"; }
+};
+
+int main()
+{
+    {
+        iosp::shared_ptr<int> sp(new int(10), iosp::lazy); // no control block allocated
+        std::cout << "use_count: " << sp.use_count() << " unique: " << std::boolalpha << sp.unique() << "\n"; // 1 true
+    } // deleted directly
+
+    iosp::shared_ptr<int> a(new int(20), iosp::lazy);
+    iosp::shared_ptr<int> b(new int(30), iosp::lazy);
+    std::cout << "distinct owners ordered: " << (a.owner_before(b) != b.owner_before(a)) << "\n"; // true
+
+    iosp::shared_ptr<int> a2 = a; // first copy allocates the control block
+    std::cout << "after copy a: " << a.use_count() << " a2: " << a2.use_count() << "\n"; // 2 2
+    std::cout << "same owner: " << (!a.owner_before(a2) && !a2.owner_before(a)) << "\n"; // true
+
+    iosp::shared_ptr<int> moved = std::move(b); // moving keeps it lazy
+    std::cout << "moved use_count: " << moved.use_count() << "\n"; // 1
+
+    std::cout << "\n---- converting a lazy Derived owner ----\n";
+    iosp::shared_ptr<Derived> d(new Derived, iosp::lazy);
+    iosp::shared_ptr<int> alias(d, &d->value);
+    iosp::shared_ptr<Base> base(std::move(d));
+    std::cout << "base use_count: " << base.use_count() << " alias: " << *alias << "\n"; // 2 7
+    base.reset();
+    alias.reset(); // Derived destroyed, then Base
+
+    std::cout << "\n---- converting assignment ----\n";
+    iosp::shared_ptr<Derived> d2(new Derived, iosp::lazy);
+    iosp::shared_ptr<Base> base2;
+    base2 = d2;
+    std::cout << "base2 use_count: " << base2.use_count() << "\n"; // 2
+
+    std::cout << "\n---- identity and concurrent first copies ----\n";
+    std::cout << "copies noexcept: " << std::is_nothrow_copy_constructible_v<iosp::shared_ptr<int>> << "\n"; // true
+    iosp::shared_ptr<int> key(new int(40), iosp::lazy);
+    const void* before = key.owner_id();
+    iosp::shared_ptr<int> key_copy = key;
+    std::cout << "owner_id kept: " << (key.owner_id() == before && key_copy.owner_id() == before) << "\n"; // true
+
+    constexpr int rounds = 200;
+    int counts_ok = 0;
+    for(int r = 0; r < rounds; r++) {
+        iosp::shared_ptr<Counted> source(new Counted, iosp::lazy);
+        const iosp::shared_ptr<Counted>& view = source; // both threads copy through a const reference
+        iosp::shared_ptr<Counted> c1, c2;
+        std::thread t1([&] { c1 = view; });
+        std::thread t2([&] { c2 = view; });
+        t1.join();
+        t2.join();
+        counts_ok += source.use_count() == 3 && c1.owner_id() == c2.owner_id();
+    }
+    std::cout << "one block per owner: " << (counts_ok == rounds) << " destroyed once: " << (Counted::destroyed == rounds) << "\n"; // true true
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include "../../unique_ptr.hpp"
+#include <memory>
+#include "../../shared_ptr.hpp"
+#include <iostream>
+
+struct Row {
+    int id;
+    double score;
+    Row(int i, double s) : id(i), score(s) {}
+    ~Row() { std::cout << "Row " << id << " destroyed\n"; }
+};
+
+int main()
+{
+    auto rows = iosp::make_shared_group<Row>(4, [](size_t i) { return Row(int(i), i * 0.5); });
+
+    std::cout << "rows[0].use_count(): " << rows[0].use_count() << "\n"; // 4, one control block
+    std::cout << "contiguous: " << std::boolalpha << (rows[3].get() == rows[0].get() + 3) << "\n"; // true
+    std::cout << "rows[2]: " << rows[2]->id << " " << rows[2]->score << "\n"; // 2 1
+
+    iosp::shared_ptr<Row> keep = rows[1];
+    rows.clear(); // nothing destroyed yet, keep holds the group
+    std::cout << "keep.use_count(): " << keep.use_count() << "\n"; // 1
+
+    std::cout << "\n---- release last reference ----\n";
+    keep.reset(); // all four rows destroyed together
+
+    auto empty = iosp::make_shared_group<int>(0);
+    std::cout << "empty group size: " << empty.size() << "\n"; // 0
+
+    return 0;
+}
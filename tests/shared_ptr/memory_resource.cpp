@@ -0,0 +1,49 @@
+#include "../../unique_ptr.hpp"
+#include <memory>
+#include <memory_resource>
+#include "../../shared_ptr.hpp"
+#include <iostream>
+
+// forwards to new_delete_resource() and counts what passes through
+struct counting_resource : std::pmr::memory_resource {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        deallocations++;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+int main()
+{
+    counting_resource counter;
+    {
+        iosp::shared_ptr<int> sp(new int(5), std::default_delete<int>{}, &counter); // control block only
+        iosp::shared_ptr<int> copy = sp;
+        std::cout << "control block allocations: " << counter.allocations << " value " << *copy << "\n"; // 1 5
+    }
+    std::cout << "deallocations: " << counter.deallocations << "\n"; // 1
+
+    {
+        // fused allocation, the pmr vector inside picks up the same resource
+        auto v = iosp::allocate_shared<std::pmr::vector<int>>(&counter, 3, 7);
+        std::cout << "vector size: " << v->size() << " uses resource: " << std::boolalpha
+                  << (v->get_allocator().resource() == &counter) << "\n"; // 3 true
+        std::cout << "allocations: " << counter.allocations << "\n"; // 3, block + vector buffer
+    }
+    std::cout << "deallocations: " << counter.deallocations << "\n"; // 3
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto in_arena = iosp::allocate_shared<int>(&arena, 42);
+    std::cout << "arena value: " << *in_arena << "\n"; // 42
+
+    return 0;
+}
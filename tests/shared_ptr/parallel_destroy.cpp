@@ -0,0 +1,58 @@
+#include "../../unique_ptr.hpp"
+#include "../../shared_ptr.hpp"
+#include "../../parallel_destroy.hpp"
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+std::atomic_int destroyed{0};
+
+struct Entry
+{
+    long key;
+    int part = 0;
+    explicit Entry(long k) : key(k) {}
+    ~Entry() { destroyed.fetch_add(1, std::memory_order_relaxed); }
+};
+
+iosp::shared_ptr<Entry> immortal = iosp::make_immortal_shared<Entry>(-2);
+
+int main()
+{
+    std::cout << std::boolalpha;
+    constexpr long objects = 100000;
+
+    // every object is referenced from three places far apart, so its references land in different slices
+    std::vector<iosp::shared_ptr<Entry>> cache(objects * 3);
+    for(long i = 0; i < objects; i++) {
+        auto e = iosp::make_shared<Entry>(i);
+        cache[i] = e;
+        cache[i + objects] = e;
+        cache[i + 2 * objects] = e;
+    }
+    iosp::parallel_destroy(cache.begin(), cache.end(), 4);
+    bool all_empty = true;
+    for(auto& p : cache)
+        all_empty = all_empty && !p;
+    std::cout << "destroyed once each: " << (destroyed.load() == objects) << " range emptied: " << all_empty << "\n"; // destroyed once each: true range emptied: true
+
+    destroyed = 0;
+    std::vector<iosp::shared_ptr<Entry>> mixed;
+    auto kept = iosp::make_shared<Entry>(-1);
+    for(long i = 0; i < objects; i++) {
+        auto e = iosp::make_shared<Entry>(i);
+        mixed.push_back(e);
+        mixed.push_back(kept);
+        mixed.push_back(immortal);
+        mixed.push_back(iosp::shared_ptr<Entry>(new Entry(i), iosp::lazy));
+    }
+    iosp::parallel_destroy(mixed.begin(), mixed.end(), 3);
+    std::cout << "destroyed: " << destroyed.load() << " kept alive: " << kept.use_count() << "\n"; // destroyed: 200000 kept alive: 1
+
+    destroyed = 0;
+    std::vector<iosp::shared_ptr<Entry>> small(10, kept);
+    iosp::parallel_destroy(small.begin(), small.end()); // too small to split, runs on this thread
+    std::cout << "small range: " << destroyed.load() << " " << kept.use_count() << "\n"; // small range: 0 1
+
+    return 0;
+}
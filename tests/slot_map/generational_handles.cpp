@@ -0,0 +1,48 @@
+#include "../../unique_ptr.hpp"
+#include "../../slot_map.hpp"
+#include <iostream>
+#include <string>
+
+struct Entity
+{
+    std::string name;
+    int hp;
+    Entity(std::string n, int h) : name(std::move(n)), hp(h) {}
+};
+
+int main()
+{
+    iosp::slot_map<Entity> world;
+    auto orc = world.emplace("orc", 30);
+    auto elf = world.emplace("elf", 20);
+    auto imp = world.insert(iosp::make_unique<Entity>("imp", 5)); // ownership moves into the map
+
+    std::cout << std::boolalpha;
+    std::cout << world.get(elf)->name << " " << world.size() << "\n"; // elf 3
+
+    world.erase(orc);
+    std::cout << "orc stale: " << (world.get(orc) == nullptr) << "\n"; // true
+    std::cout << "imp still resolves: " << world.get(imp)->name << "\n"; // imp, moved into the hole
+
+    auto troll = world.emplace("troll", 50); // reuses orc's slot with a new generation
+    std::cout << "slot reused: " << (troll.index == orc.index) << " old handle stale: " << !world.contains(orc) << "\n"; // slot reused: true old handle stale: true
+    std::cout << "default handle: " << world.contains(iosp::handle<Entity>{}) << "\n"; // false
+
+    int total = 0;
+    for(auto& e : world) // linear over packed storage
+        total += e.hp;
+    std::cout << "total hp: " << total << "\n"; // 75
+
+    for(size_t i = 0; i < world.size(); i++)
+        if(world.handle_at(i) == elf)
+            std::cout << "elf at position " << i << "\n"; // elf at position 1
+
+    iosp::unique_ptr<Entity> taken = world.take(elf); // and back out
+    std::cout << "taken: " << taken->name << " stale now: " << !world.contains(elf) << " size " << world.size() << "\n"; // taken: elf stale now: true size 2
+    std::cout << "take stale: " << (world.take(elf).get() == nullptr) << "\n"; // true
+
+    world.clear();
+    std::cout << "after clear: " << world.empty() << " " << world.contains(troll) << "\n"; // true false
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "../../unique_ptr.hpp"
+#include "../../traced_ptr.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static std::atomic_int live{0};
+
+struct Plugin {
+    int id;
+    std::vector<iosp::traced_ptr<Plugin>> deps;
+
+    explicit Plugin(int i) : id(i) { live++; }
+    ~Plugin() { live--; }
+
+    template<typename Visitor>
+    void trace(Visitor& v) const {
+        for(const auto& d : deps)
+            v(d);
+    }
+};
+
+int main()
+{
+    auto& collector = iosp::cycle_collector::instance();
+
+    {
+        auto a = iosp::make_traced<Plugin>(1);
+        auto b = iosp::make_traced<Plugin>(2);
+        a->deps.push_back(b);
+        b->deps.push_back(a); // a <-> b
+        auto self = iosp::make_traced<Plugin>(3);
+        self->deps.push_back(self);
+    }
+    std::cout << "live after dropping cycles: " << live.load() << "\n"; // 3, leaked until collected
+    std::cout << "freed: " << collector.collect() << " live: " << live.load() << "\n"; // 3 0
+
+    auto root = iosp::make_traced<Plugin>(10);
+    {
+        auto c = iosp::make_traced<Plugin>(11);
+        root->deps.push_back(c);
+        c->deps.push_back(root); // cycle, but root is still held
+        auto tail = iosp::make_traced<Plugin>(12);
+        c->deps.push_back(tail);
+    }
+    std::cout << "freed with outside reference: " << collector.collect() << " live: " << live.load() << "\n"; // 0 3
+
+    root.reset(); // now the whole ring plus its tail is garbage
+    std::cout << "freed after release: " << collector.collect() << " live: " << live.load() << "\n"; // 3 0
+
+    std::cout << "\n---- background collection while mutators run ----\n";
+    collector.start_background(std::chrono::milliseconds(1), 64);
+    std::vector<std::thread> mutators;
+    for(int t = 0; t < 4; t++) {
+        mutators.emplace_back([t] {
+            iosp::traced_ptr<Plugin> keep = iosp::make_traced<Plugin>(t);
+            for(int i = 0; i < 2000; i++) {
+                auto x = iosp::make_traced<Plugin>(i);
+                auto y = iosp::make_traced<Plugin>(i);
+                iosp::cycle_collector::mutation_guard guard; // the vectors below are edges the collector traces
+                x->deps.push_back(y);
+                y->deps.push_back(x);
+                if(i % 10 == 0)
+                    keep->deps.push_back(x); // some rings stay reachable
+            }
+            if(keep->deps.size() != 200 || keep->deps.back()->deps.front()->deps.front().get() != keep->deps.back().get())
+                std::cout << "corrupted ring\n";
+        });
+    }
+    for(auto& m : mutators)
+        m.join();
+    collector.stop_background();
+    collector.collect();
+    std::cout << "live after background run: " << live.load() << "\n"; // 0
+
+    return live.load() == 0 ? 0 : 1;
+}
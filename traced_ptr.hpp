@@ -0,0 +1,512 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "unique_ptr.hpp"
+
+// Opt-in reference counted pointer whose cycles can be reclaimed.
+// Objects created by make_traced<T>() report their outgoing traced_ptrs through a member
+//     template<typename Visitor> void trace(Visitor& v) const { v(left); v(right); }
+// and cycle_collector runs Bacon-Rajan trial deletion over the objects whose count dropped
+// without reaching zero: it subtracts the internal edges of the subgraph reachable from those
+// candidates and frees whatever is left with no outside reference.
+//
+// Every traced_ptr copy, move, assignment and destruction holds the collector lock shared, a
+// collection step holds it exclusively, so a step pauses mutators only for the roots it processes.
+// Code that changes a traced object's edges some other way (push_back on a vector of traced_ptrs)
+// must hold a cycle_collector::mutation_guard around it while a background collector runs
+
+namespace iosp { // implementation of smart pointers
+    template<typename T>
+    class traced_ptr;
+
+    class cycle_collector;
+
+    template<typename T, typename... Args>
+    _NODISCARD auto make_traced(Args&&... args) -> iosp::traced_ptr<T>;
+}
+
+struct traced_control_block;
+
+// Handed to T::trace, calls visit() for every non-null traced_ptr it is given
+struct traced_visitor
+{
+    template<typename... Us>
+    auto operator()(const iosp::traced_ptr<Us>&... children) -> void {
+        (visit_pointer(children), ...);
+    }
+
+    virtual auto visit(traced_control_block* child) -> void = 0;
+
+protected:
+    ~traced_visitor() = default;
+
+private:
+    template<typename U>
+    auto visit_pointer(const iosp::traced_ptr<U>& child) -> void;
+};
+
+struct traced_control_block
+{
+    enum class color : std::uint8_t { black, gray, white };
+
+    std::atomic_size_t strong_ref{1};
+    std::atomic_bool buffered{false}; // sitting in the collector's candidate roots
+    size_t trial_ref = 0; // collector only
+    color mark = color::black; // collector only
+
+    virtual ~traced_control_block() = default;
+    virtual auto trace(traced_visitor& v) -> void = 0;
+    virtual auto destroy_object() -> void = 0; // runs ~T, which releases the outgoing edges
+    virtual auto deallocate() -> void = 0;
+};
+
+template<typename T>
+struct traced_object_block : traced_control_block
+{
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    auto object() -> T* {
+        return reinterpret_cast<T*>(storage);
+    }
+    auto trace(traced_visitor& v) -> void override {
+        object()->trace(v);
+    }
+    auto destroy_object() -> void override {
+        object()->~T();
+    }
+    auto deallocate() -> void override {
+        delete this;
+    }
+};
+
+class iosp::cycle_collector
+{
+    std::shared_mutex graph_mutex; // shared by mutators, exclusive for a collection step
+    std::mutex roots_mutex;
+    std::vector<traced_control_block*> roots;
+    std::atomic_size_t freed{0};
+
+    std::thread background;
+    std::mutex background_mutex;
+    std::condition_variable background_wakeup;
+    bool background_running = false;
+
+    inline static thread_local size_t lock_depth = 0;
+    inline static thread_local bool collecting = false;
+
+    cycle_collector() = default;
+
+    template<typename F>
+    static auto for_each_child(traced_control_block* cb, F f) -> void;
+    auto mark_gray(traced_control_block* s) -> void;
+    auto scan(traced_control_block* s) -> void;
+    auto scan_black(traced_control_block* s) -> void;
+    auto collect_white(traced_control_block* s, std::vector<traced_control_block*>& whites) -> void;
+
+public:
+    // Holds the collector lock shared for the outermost traced_ptr operation on this thread
+    struct mutation_guard
+    {
+        mutation_guard();
+        ~mutation_guard();
+        mutation_guard(const mutation_guard&) = delete;
+        auto operator=(const mutation_guard&) -> mutation_guard& = delete;
+    };
+
+    cycle_collector(const cycle_collector&) = delete;
+    auto operator=(const cycle_collector&) -> cycle_collector& = delete;
+    ~cycle_collector();
+
+    static auto instance() -> cycle_collector&;
+
+    auto release(traced_control_block* cb) -> void; // caller holds a mutation_guard
+    auto collect_step(size_t max_roots) -> size_t; // returns the number of objects freed
+    auto collect() -> size_t; // steps until no candidate is left
+    auto start_background(std::chrono::milliseconds interval, size_t max_roots_per_step) -> void;
+    auto stop_background() -> void;
+    _NODISCARD auto pending_roots() -> size_t;
+    _NODISCARD auto freed_by_collection() const noexcept -> size_t;
+};
+
+template<typename U>
+auto traced_visitor::visit_pointer(const iosp::traced_ptr<U>& child) -> void
+{
+    if(child.cb)
+        visit(child.cb);
+}
+
+inline iosp::cycle_collector::mutation_guard::mutation_guard()
+{
+    if(lock_depth++ == 0)
+        instance().graph_mutex.lock_shared();
+}
+
+inline iosp::cycle_collector::mutation_guard::~mutation_guard()
+{
+    if(--lock_depth == 0)
+        instance().graph_mutex.unlock_shared();
+}
+
+inline iosp::cycle_collector::~cycle_collector()
+{
+    stop_background();
+}
+
+inline auto iosp::cycle_collector::instance() -> cycle_collector&
+{
+    static cycle_collector collector;
+    return collector;
+}
+
+inline auto iosp::cycle_collector::release(traced_control_block* cb) -> void
+{
+    if(collecting && cb->mark == traced_control_block::color::white) {
+        cb->strong_ref.fetch_sub(1, std::memory_order_relaxed); // garbage being torn down by this step
+        return;
+    }
+    // a count that stays above zero may have just lost the last outside reference to a cycle.
+    // Buffer while we still own a reference, so the block cannot be freed under us
+    if(cb->strong_ref.load(std::memory_order_acquire) != 1 && !cb->buffered.exchange(true)) {
+        std::lock_guard<std::mutex> lock(roots_mutex);
+        roots.push_back(cb);
+    }
+    if(cb->strong_ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        cb->destroy_object();
+        if(!cb->buffered.load(std::memory_order_relaxed))
+            cb->deallocate(); // otherwise the collector frees the block when it reaches the root
+    }
+}
+
+template<typename F>
+auto iosp::cycle_collector::for_each_child(traced_control_block* cb, F f) -> void
+{
+    struct adapter : traced_visitor
+    {
+        F& f;
+        explicit adapter(F& fn) : f(fn) {}
+        auto visit(traced_control_block* child) -> void override { f(child); }
+    } v(f);
+    cb->trace(v);
+}
+
+// Trial deletion: subtract every internal edge of the subgraph reachable from s
+inline auto iosp::cycle_collector::mark_gray(traced_control_block* s) -> void
+{
+    using color = traced_control_block::color;
+    if(s->mark == color::gray)
+        return;
+    s->mark = color::gray;
+    s->trial_ref = s->strong_ref.load(std::memory_order_relaxed);
+    std::vector<traced_control_block*> stack{s}; // explicit stacks, candidate subgraphs can be long chains
+    while(!stack.empty()) {
+        traced_control_block* n = stack.back();
+        stack.pop_back();
+        for_each_child(n, [&](traced_control_block* t) {
+            if(t->mark != color::gray) {
+                t->mark = color::gray;
+                t->trial_ref = t->strong_ref.load(std::memory_order_relaxed);
+                stack.push_back(t);
+            }
+            t->trial_ref--;
+        });
+    }
+}
+
+// Anything still counted from outside is live and so is everything it reaches, the rest is white
+inline auto iosp::cycle_collector::scan(traced_control_block* s) -> void
+{
+    using color = traced_control_block::color;
+    std::vector<traced_control_block*> stack{s};
+    while(!stack.empty()) {
+        traced_control_block* n = stack.back();
+        stack.pop_back();
+        if(n->mark != color::gray)
+            continue;
+        if(n->trial_ref > 0) {
+            scan_black(n);
+        } else {
+            n->mark = color::white;
+            for_each_child(n, [&](traced_control_block* t) { stack.push_back(t); });
+        }
+    }
+}
+
+inline auto iosp::cycle_collector::scan_black(traced_control_block* s) -> void
+{
+    using color = traced_control_block::color;
+    s->mark = color::black;
+    std::vector<traced_control_block*> stack{s};
+    while(!stack.empty()) {
+        traced_control_block* n = stack.back();
+        stack.pop_back();
+        for_each_child(n, [&](traced_control_block* t) {
+            t->trial_ref++;
+            if(t->mark != color::black) {
+                t->mark = color::black;
+                stack.push_back(t);
+            }
+        });
+    }
+}
+
+inline auto iosp::cycle_collector::collect_white(traced_control_block* s, std::vector<traced_control_block*>& whites) -> void
+{
+    using color = traced_control_block::color;
+    std::vector<traced_control_block*> stack{s};
+    while(!stack.empty()) {
+        traced_control_block* n = stack.back();
+        stack.pop_back();
+        if(n->mark != color::white || n->trial_ref == SIZE_MAX)
+            continue;
+        n->trial_ref = SIZE_MAX; // gathered, stays white so releases from sibling garbage are skipped
+        whites.push_back(n);
+        for_each_child(n, [&](traced_control_block* t) { stack.push_back(t); });
+    }
+}
+
+inline auto iosp::cycle_collector::collect_step(size_t max_roots) -> size_t
+{
+    using color = traced_control_block::color;
+    std::unique_lock<std::shared_mutex> exclusive(graph_mutex);
+    lock_depth++; // traced_ptr destructors run below must not lock again
+
+    std::vector<traced_control_block*> batch;
+    {
+        std::lock_guard<std::mutex> lock(roots_mutex);
+        size_t n = roots.size() < max_roots ? roots.size() : max_roots;
+        batch.assign(roots.end() - n, roots.end());
+        roots.resize(roots.size() - n);
+    }
+
+    std::vector<traced_control_block*> candidates;
+    for(traced_control_block* s : batch) {
+        s->buffered.store(false, std::memory_order_relaxed);
+        if(s->strong_ref.load(std::memory_order_relaxed) == 0)
+            s->deallocate(); // its object died while it waited here
+        else
+            candidates.push_back(s);
+    }
+
+    for(traced_control_block* s : candidates)
+        mark_gray(s);
+    for(traced_control_block* s : candidates)
+        scan(s);
+    std::vector<traced_control_block*> whites;
+    for(traced_control_block* s : candidates)
+        collect_white(s, whites);
+
+    collecting = true;
+    for(traced_control_block* w : whites)
+        w->destroy_object();
+    collecting = false;
+    for(traced_control_block* w : whites) {
+        w->mark = color::black;
+        w->strong_ref.store(0, std::memory_order_relaxed);
+        if(!w->buffered.load(std::memory_order_relaxed))
+            w->deallocate(); // a white still queued as a root is freed when a later step reaches it
+    }
+
+    lock_depth--;
+    freed.fetch_add(whites.size(), std::memory_order_relaxed);
+    return whites.size();
+}
+
+inline auto iosp::cycle_collector::collect() -> size_t
+{
+    size_t total = 0;
+    while(pending_roots() != 0)
+        total += collect_step(SIZE_MAX);
+    return total;
+}
+
+inline auto iosp::cycle_collector::start_background(std::chrono::milliseconds interval, size_t max_roots_per_step) -> void
+{
+    std::lock_guard<std::mutex> lock(background_mutex);
+    if(background_running)
+        return;
+    background_running = true;
+    background = std::thread([this, interval, max_roots_per_step] {
+        std::unique_lock<std::mutex> lock(background_mutex);
+        while(!background_wakeup.wait_for(lock, interval, [this] { return !background_running; })) {
+            lock.unlock();
+            collect_step(max_roots_per_step);
+            lock.lock();
+        }
+    });
+}
+
+inline auto iosp::cycle_collector::stop_background() -> void
+{
+    {
+        std::lock_guard<std::mutex> lock(background_mutex);
+        if(!background_running)
+            return;
+        background_running = false;
+    }
+    background_wakeup.notify_all();
+    background.join();
+}
+
+inline auto iosp::cycle_collector::pending_roots() -> size_t
+{
+    std::lock_guard<std::mutex> lock(roots_mutex);
+    return roots.size();
+}
+
+inline auto iosp::cycle_collector::freed_by_collection() const noexcept -> size_t
+{
+    return freed.load(std::memory_order_relaxed);
+}
+
+template<typename T, typename... Args>
+_NODISCARD auto iosp::make_traced(Args&&... args) -> iosp::traced_ptr<T>
+{
+    auto* cb = new traced_object_block<T>();
+    try {
+        new (cb->object()) T(std::forward<Args>(args)...);
+    } catch(...) {
+        delete cb;
+        throw;
+    }
+    return iosp::traced_ptr<T>(cb->object(), cb);
+}
+
+template<typename T>
+class iosp::traced_ptr
+{
+    T* pointer = nullptr;
+    traced_control_block* cb = nullptr;
+
+    friend struct ::traced_visitor;
+    template<typename U, typename... Args>
+    friend auto iosp::make_traced(Args&&... args) -> iosp::traced_ptr<U>;
+
+    traced_ptr(T* _Ptr, traced_control_block* _CB) noexcept : pointer(_Ptr), cb(_CB) {}
+
+public:
+    // Constructors && Destructor
+    traced_ptr() noexcept = default;
+    traced_ptr(std::nullptr_t) noexcept {}
+    traced_ptr(const traced_ptr& s);
+    traced_ptr(traced_ptr&& s);
+    ~traced_ptr();
+
+    // Operators
+    auto operator=(const traced_ptr& s) -> traced_ptr&;
+    auto operator=(traced_ptr&& s) -> traced_ptr&;
+    auto operator=(std::nullptr_t) -> traced_ptr&;
+    _NODISCARD auto operator*() const noexcept -> T&;
+    _NODISCARD auto operator->() const noexcept -> T*;
+    explicit operator bool() const noexcept;
+
+    // Members
+    _NODISCARD auto get() const noexcept -> T*;
+    _NODISCARD auto use_count() const noexcept -> std::size_t;
+    auto reset() -> void;
+    auto swap(traced_ptr& other) -> void;
+};
+
+template <typename T>
+iosp::traced_ptr<T>::traced_ptr(const traced_ptr& s)
+{
+    iosp::cycle_collector::mutation_guard guard;
+    pointer = s.pointer;
+    cb = s.cb;
+    if(cb)
+        cb->strong_ref.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+iosp::traced_ptr<T>::traced_ptr(traced_ptr&& s)
+{
+    iosp::cycle_collector::mutation_guard guard; // moving out of a heap object removes an edge
+    pointer = s.pointer;
+    cb = s.cb;
+    s.pointer = nullptr;
+    s.cb = nullptr;
+}
+
+template <typename T>
+iosp::traced_ptr<T>::~traced_ptr()
+{
+    reset();
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::operator=(const traced_ptr& s) -> traced_ptr&
+{
+    traced_ptr(s).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::operator=(traced_ptr&& s) -> traced_ptr&
+{
+    traced_ptr(std::move(s)).swap(*this);
+    return *this;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::operator=(std::nullptr_t) -> traced_ptr&
+{
+    reset();
+    return *this;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::operator*() const noexcept -> T&
+{
+    return *pointer;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::operator->() const noexcept -> T*
+{
+    return pointer;
+}
+
+template <typename T>
+iosp::traced_ptr<T>::operator bool() const noexcept
+{
+    return pointer != nullptr;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::get() const noexcept -> T*
+{
+    return pointer;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::use_count() const noexcept -> std::size_t
+{
+    return cb ? cb->strong_ref.load(std::memory_order_relaxed) : 0;
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::reset() -> void
+{
+    if(!cb)
+        return;
+    iosp::cycle_collector::mutation_guard guard;
+    traced_control_block* old = cb;
+    pointer = nullptr;
+    cb = nullptr; // detached first, the object's destructor may reach back into this pointer
+    iosp::cycle_collector::instance().release(old);
+}
+
+template <typename T>
+auto iosp::traced_ptr<T>::swap(traced_ptr& other) -> void
+{
+    iosp::cycle_collector::mutation_guard guard;
+    std::swap(pointer, other.pointer);
+    std::swap(cb, other.cb);
+}
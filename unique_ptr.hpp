@@ -2,6 +2,7 @@
 #include <iostream>
 #include <memory>
 #include <type_traits>
+#include "teardown.hpp"
 
 #define _NODISCARD [[nodiscard]]
 
@@ -36,6 +37,8 @@ class iosp::unique_ptr
 {
     Ptr* pointer;
     Deleter deleter;
+
+    auto dispose(Ptr* p) noexcept -> void; // through the teardown worklist when Ptr opted in
 public:
     // Constructors && Destructor
     unique_ptr() noexcept;
@@ -57,6 +60,7 @@ public:
 
     // Members
     _NODISCARD auto get() const noexcept -> Ptr*;
+    _NODISCARD auto get_deleter() noexcept -> Deleter&;
     _NODISCARD auto get_deleter() const noexcept -> const Deleter&;
     auto release() noexcept -> Ptr*;
     auto reset(Ptr* _Ptr = nullptr) noexcept -> void;
@@ -129,7 +133,16 @@ template <typename Ptr, typename Deleter>
 iosp::unique_ptr<Ptr, Deleter>::~unique_ptr()
 {
     if(pointer)
-        deleter(pointer); // or get_deleter(get())
+        dispose(pointer); // or get_deleter(get())
+}
+
+template <typename Ptr, typename Deleter>
+auto iosp::unique_ptr<Ptr, Deleter>::dispose(Ptr* p) noexcept -> void
+{
+    if constexpr(iosp::has_deferred_teardown_v<Ptr> && std::is_empty_v<Deleter> && std::is_default_constructible_v<Deleter>)
+        teardown_worklist::run([](void* q) { Deleter{}(static_cast<Ptr*>(q)); }, p);
+    else
+        deleter(p);
 }
 
 template <typename Ptr, typename Deleter>
@@ -137,7 +150,8 @@ auto iosp::unique_ptr<Ptr, Deleter>::operator=(unique_ptr&& u) noexcept -> uniqu
 {
     static_assert(std::is_nothrow_move_constructible_v<decltype(u.deleter)>); // deleter must be a nothrow move constructible
     if(this != &u) {
-        deleter(pointer);
+        if(pointer)
+            dispose(pointer);
         pointer = u.pointer;
         deleter = std::move(u.deleter);
         u.pointer = nullptr;
@@ -148,7 +162,7 @@ auto iosp::unique_ptr<Ptr, Deleter>::operator=(unique_ptr&& u) noexcept -> uniqu
 template <typename Ptr, typename Deleter>
 auto iosp::unique_ptr<Ptr, Deleter>::operator=(std::nullptr_t) noexcept -> unique_ptr&
 {
-    reset(pointer);
+    reset();
     return *this;
 }
 
@@ -176,6 +190,12 @@ auto iosp::unique_ptr<Ptr, Deleter>::get() const noexcept -> Ptr*
     return pointer;
 }
 
+template <typename Ptr, typename Deleter>
+auto iosp::unique_ptr<Ptr, Deleter>::get_deleter() noexcept -> Deleter&
+{
+    return deleter;
+}
+
 template <typename Ptr, typename Deleter>
 auto iosp::unique_ptr<Ptr, Deleter>::get_deleter() const noexcept -> const Deleter&
 {
@@ -194,7 +214,7 @@ template <typename Ptr, typename Deleter>
 auto iosp::unique_ptr<Ptr, Deleter>::reset(Ptr* _Ptr) noexcept -> void
 {
     if(pointer)
-        deleter(pointer);
+        dispose(pointer);
     pointer = _Ptr;
 }
 
@@ -230,6 +250,7 @@ public:
 
     // Members
     _NODISCARD auto get() const noexcept -> Ptr*;
+    _NODISCARD auto get_deleter() noexcept -> Deleter&;
     _NODISCARD auto get_deleter() const noexcept -> const Deleter&;
     _NODISCARD auto release() noexcept -> Ptr*;
     auto reset(Ptr* _Ptr = nullptr) noexcept -> void;
@@ -296,7 +317,8 @@ auto iosp::unique_ptr<Ptr[], Deleter>::operator=(unique_ptr&& u) noexcept -> uni
 {
     static_assert(std::is_nothrow_move_constructible_v<decltype(u.deleter)>); // deleter must be a nothrow move constructible
     if(this != &u) {
-        deleter(pointer);
+        if(pointer)
+            deleter(pointer);
         pointer = u.pointer;
         deleter = std::move(u.deleter);
         u.pointer = nullptr;
@@ -307,7 +329,7 @@ auto iosp::unique_ptr<Ptr[], Deleter>::operator=(unique_ptr&& u) noexcept -> uni
 template <typename Ptr, typename Deleter>
 auto iosp::unique_ptr<Ptr[], Deleter>::operator=(std::nullptr_t) noexcept -> unique_ptr&
 {
-    reset(pointer);
+    reset();
     return *this;
 }
 
@@ -329,6 +351,12 @@ auto iosp::unique_ptr<Ptr[], Deleter>::get() const noexcept -> Ptr*
     return pointer;
 }
 
+template <typename Ptr, typename Deleter>
+auto iosp::unique_ptr<Ptr[], Deleter>::get_deleter() noexcept -> Deleter&
+{
+    return deleter;
+}
+
 template <typename Ptr, typename Deleter>
 auto iosp::unique_ptr<Ptr[], Deleter>::get_deleter() const noexcept -> const Deleter&
 {